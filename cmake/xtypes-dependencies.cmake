@@ -1,5 +1,6 @@
 # Find all dependencies
 find_package(PkgConfig REQUIRED)
+find_package(Threads REQUIRED)
 pkg_check_modules(libgit2 REQUIRED IMPORTED_TARGET libgit2)
 
 find_package(nlohmann_json 3.10.5 REQUIRED)
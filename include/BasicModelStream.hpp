@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <xtypes_generator/XType.hpp>
+
+namespace xtypes
+{
+    class ComponentModel;
+
+    /**
+     * @brief The encodings of the DROCK BasicModel Json format. The binary ones (CBOR and MessagePack) have the same schema as the text one.
+     */
+    enum class BasicModelEncoding
+    {
+        JSON,
+        CBOR,
+        MSGPACK
+    };
+
+    /**
+     * @brief Exports a component model to the DROCK BasicModel Json format in the given encoding
+     */
+    std::vector< std::uint8_t > export_to_basic_model(const std::shared_ptr< ComponentModel >& model, const BasicModelEncoding encoding);
+
+    /**
+     * @brief Receives the serialization of a model piece by piece
+     */
+    using BasicModelWriteFunc = std::function< void(const char*, const std::size_t) >;
+
+    /**
+     * @brief Exports a component model to the DROCK BasicModel Json format while walking it
+     * The document is never held in memory as a whole. The output is the same as the one of ComponentModel::export_to_basic_model().
+     */
+    void export_to_basic_model(const std::shared_ptr< ComponentModel >& model, const BasicModelWriteFunc& write);
+    void export_to_basic_model(const std::shared_ptr< ComponentModel >& model, std::ostream& out);
+
+    /**
+     * @brief Imports component models from the DROCK BasicModel Json format in the given encoding (see ComponentModel::import_from_basic_model())
+     */
+    std::vector< std::shared_ptr< ComponentModel > > import_from_basic_model(const std::vector< std::uint8_t >& encoded_model, const BasicModelEncoding encoding, const XTypeRegistryPtr& registry, const nl::json& with_options = nl::json::object());
+
+    /**
+     * @brief Imports component models from the DROCK BasicModel Json format while reading them from a stream
+     * The document is never held in memory as a whole. Parts, connections and configurations are created one by one while they are read.
+     * The stream has to be seekable, because it is read multiple times. Otherwise its content gets buffered first.
+     * The with_options are the ones of ComponentModel::import_from_basic_model().
+     */
+    std::vector< std::shared_ptr< ComponentModel > > import_from_basic_model(std::istream& in, const XTypeRegistryPtr& registry, const nl::json& with_options = nl::json::object(), const BasicModelEncoding encoding = BasicModelEncoding::JSON);
+
+    /**
+     * @brief Loads many XTypes at once (e.g. with a single database query) and returns them by the requested URIs
+     * URIs which could not be loaded are left out. Like the load function of a registry, the hook has to make the loaded XTypes known to the registry.
+     */
+    using BatchLoadFunc = std::function< std::map< std::string, XTypePtr >(const std::vector< std::string >&) >;
+
+    /**
+     * @brief Sets (or removes if func is nullptr) the batch load hook of a registry
+     * If set, the imports from the DROCK BasicModel Json format collect the URIs of all referenced models first and load them with a single call of the hook.
+     */
+    void set_batch_load_func(const XTypeRegistryPtr& registry, const BatchLoadFunc& func);
+
+    /**
+     * @brief Returns the batch load hook of a registry (or nullptr if there is none)
+     */
+    BatchLoadFunc get_batch_load_func(const XTypeRegistryPtr& registry);
+}
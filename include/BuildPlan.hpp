@@ -0,0 +1,195 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <xtypes_generator/XType.hpp>
+
+namespace xtypes
+{
+    class Component;
+    class ComponentModel;
+    class Interface;
+    class InterfaceModel;
+    class Module;
+
+    /**
+     * @brief A node of the resolved part hierarchy of a ComponentModel
+     */
+    struct BuildNode
+    {
+        static constexpr std::size_t npos = std::numeric_limits< std::size_t >::max();
+        // The part of the whole model and the (possibly implementation) model to be built from it
+        std::shared_ptr< Component > part;
+        std::shared_ptr< ComponentModel > model;
+        // Index of the parent node or npos if the parent is the toplvl module
+        std::size_t parent;
+        // Index of the toplvl node this node belongs to
+        std::size_t subtree;
+    };
+
+    // References an interface of a module to be built by (node index or npos for the toplvl module, index of the interface in its model)
+    using BuildInterfaceRef = std::pair< std::size_t, std::size_t >;
+
+    /**
+     * @brief A build plan is the flat list of steps needed to build a module out of a ComponentModel with a fixed set of implementation choices
+     */
+    struct BuildPlan
+    {
+        // The model this plan has been compiled for
+        std::shared_ptr< ComponentModel > model;
+        // The choices select_implementation() made during compilation (in order of occurrence)
+        struct Choice
+        {
+            std::shared_ptr< ComponentModel > abstract_model;
+            std::vector< std::shared_ptr< ComponentModel > > implementations;
+            std::shared_ptr< ComponentModel > implementation;
+        };
+        std::vector< Choice > choices;
+        // The options of ComponentModel::build() this plan has been compiled with ("implementation_policy", "memoize_selection", "max_depth" and "subtree")
+        nl::json selection_options;
+        // The submodules to be instantiated (in BFS order)
+        std::vector< BuildNode > nodes;
+        // The interfaces to be aliased (alias, original)
+        std::vector< std::pair< BuildInterfaceRef, BuildInterfaceRef > > aliases;
+        // The interfaces to be connected (from, to, connection properties)
+        std::vector< std::tuple< BuildInterfaceRef, BuildInterfaceRef, nl::json > > connections;
+    };
+
+    /**
+     * @brief The module and interface clones created for a BuildNode
+     */
+    struct BuiltNode
+    {
+        std::shared_ptr< Module > module;
+        std::vector< std::pair< std::shared_ptr< Interface >, std::shared_ptr< InterfaceModel > > > interfaces;
+    };
+
+    /**
+     * @brief The state of a lazy build shared by all modules of it
+     * The parts of a module are created when the module gets materialized. At that time the aliases between the module and its parts as well as the connections between its parts are resolved.
+     */
+    struct LazyBuild
+    {
+        std::shared_ptr< const BuildPlan > plan;
+        // The following are indexed by node (the toplvl module uses slot(BuildNode::npos))
+        // The child nodes as well as the aliases and connections (indices into the plan) to be resolved when a module gets materialized
+        std::vector< std::vector< std::size_t > > children;
+        std::vector< std::vector< std::size_t > > aliases;
+        std::vector< std::vector< std::size_t > > connections;
+        // The interfaces which have been created so far
+        std::vector< std::vector< std::shared_ptr< Interface > > > interfaces;
+
+        std::size_t slot(const std::size_t node) const { return (node == BuildNode::npos) ? plan->nodes.size() : node; }
+    };
+
+    /**
+     * @brief Records where ComponentModel::build() spends its effort
+     * The phases are "expansion" (resolving the part hierarchy), "abstract_resolution" (selecting implementations), "alias_resolution", "instantiation" (creating and linking modules and interfaces) and "wiring" (connecting interfaces).
+     * Builds with a 'cache_dir' or 'cache_plan' additionally record "cache_lookup" (hashing the model closure, looking up a cached plan and loading a cached module tree). Builds with a 'cache_dir' record "cache_store" as well.
+     * The phases do not overlap, e.g. the time spent in select_implementation is not part of the expansion.
+     */
+    struct BuildReport
+    {
+        struct Phase
+        {
+            double wall_time_ms = 0.0;
+            std::size_t modules = 0;
+            std::size_t interfaces = 0;
+            std::size_t aliases = 0;
+            std::size_t connections = 0;
+            // Number of XTypes instantiated through the registry
+            std::size_t instantiations = 0;
+            std::size_t warnings = 0;
+        };
+        std::map< std::string, Phase > phases;
+        // Where the module came from: "build", "cached_plan" or "cache_dir"
+        std::string source = "build";
+        double total_wall_time_ms = 0.0;
+
+        nl::json to_json() const;
+    };
+
+    /**
+     * @brief Measures the wall time of a phase of a BuildReport (if any) until it goes out of scope
+     */
+    class BuildPhaseTimer
+    {
+        public:
+            BuildPhaseTimer(BuildReport* report, const std::string& phase);
+            ~BuildPhaseTimer();
+            // Stops measuring early
+            void stop();
+        private:
+            BuildReport::Phase* m_phase;
+            std::chrono::steady_clock::time_point m_start;
+    };
+
+    using SelectImplementationFunc = std::function< std::shared_ptr< ComponentModel >(const std::shared_ptr< ComponentModel >&, const std::vector< std::shared_ptr< ComponentModel > >&) >;
+
+    /**
+     * @brief The registry is not meant to be accessed concurrently, so parallel builds serialize instantiation through this lock
+     */
+    std::mutex& registry_mutex();
+
+    /**
+     * @brief Counts the modifications of component models, their parts and their interfaces
+     * Build plans cached by ComponentModel::build() are only replayed as long as the count has not changed.
+     * Only modifications through the functions of these classes are counted, not the ones through the XType interface (e.g. set_property() or remove_fact() of a model).
+     */
+    void count_model_modification();
+    std::uint64_t model_modifications();
+
+    template < class T >
+    std::shared_ptr< T > instantiate_locked(XTypeRegistryPtr reg)
+    {
+        std::lock_guard< std::mutex > lock(registry_mutex());
+        return reg->instantiate<T>();
+    }
+
+    /**
+     * @brief Selects one of the implementations according to a declarative policy
+     * The policy is a list of criteria which are evaluated in order until one of them prefers an implementation. Remaining ties are resolved by the order of the implementations.
+     * A criterion either prefers certain values of a property, e.g. {"property": "maturity", "prefer": ["STABLE", "TESTING"]},
+     * or orders by a property, e.g. {"property": "version", "order": "highest"} (version strings are compared number by number)
+     */
+    std::shared_ptr< ComponentModel > select_implementation_by_policy(const nl::json& policy, const std::vector< std::shared_ptr< ComponentModel > >& implementations);
+
+    /**
+     * @brief Compiles the build plan of a non-abstract model
+     * The with_options are the ones of ComponentModel::build():
+     * - "parallel" (BOOLEAN): The subtrees of the toplvl parts are expanded on up to "max_threads" (INTEGER, default: number of cores) threads
+     * - "cache_plan" (BOOLEAN): The compiled plan is cached per model uuid and replayed as long as no model has been modified (see model_modifications()) and select_implementation makes the same choices. The cache does not keep any model alive.
+     * - "lazy" (BOOLEAN): The parts of a module are created when they are accessed through Module::get_part(), Module::configure() or Module::materialize()
+     * - "implementation_policy" (JSON): Selects implementations without calling select_implementation (see select_implementation_by_policy())
+     * - "memoize_selection" ("model" or "part"): Every abstract model (or abstract part) gets resolved only once per build
+     * - "max_depth" (INTEGER) and/or "subtree" (list of part paths, e.g. ["arm/joint1"]): Limit the expansion (the toplvl parts have depth 1). Parts which are not expanded are kept as atomic placeholder modules whose interfaces are still connected.
+     * - "cache_dir" (STRING): The built module tree is stored there in a file keyed by a content hash of the model closure and reloaded by later builds (also across processes) as long as the models are unchanged and select_implementation makes the same choices. Lazy builds are not stored.
+     * - "report" (BOOLEAN): A BuildReport of the build can be retrieved by ComponentModel::get_last_build_report() afterwards
+     * Only "implementation_policy", "memoize_selection", "max_depth" and "subtree" are considered here.
+     * If a report is given, the expansion, abstract resolution, alias resolution and wiring phases are recorded in there.
+     */
+    std::shared_ptr< const BuildPlan > compile_build_plan(const std::shared_ptr< ComponentModel >& model, const SelectImplementationFunc& select_implementation, const nl::json& with_options = nl::json::object(), BuildReport* report = nullptr);
+
+    /**
+     * @brief Creates the module and its interface clones of a node without linking them to any shared object
+     */
+    void materialize_build_node(XTypeRegistryPtr reg, const BuildNode& node, BuiltNode& built);
+
+    /**
+     * @brief Prints the connections rejected by Interface::connect_all() while building a module
+     */
+    void warn_about_rejected_connections(const nl::json& rejected);
+
+    /**
+     * @brief Prepares the lazy build of a plan
+     */
+    std::shared_ptr< LazyBuild > prepare_lazy_build(const std::shared_ptr< const BuildPlan >& plan);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <xtypes_generator/XType.hpp>
+
+namespace xtypes
+{
+    /**
+     * @brief Caches the uri of an xtype
+     * The cached uri is kept together with the inputs it has been built from. The owner passes the current inputs on every access,
+     * so changes are detected no matter how they have been made (e.g. through a XTypePtr or the generated base class).
+     * Comparing the inputs is cheap compared to building a deep uri, because the uri of a parent which caches its uri as well only enters by its version.
+     */
+    class CachedUri
+    {
+        public:
+            /// The current inputs of a uri
+            /// NOTE: The parent and the properties point into the owner, so they are only copied if the uri has to be rebuilt
+            struct Inputs
+            {
+                /// The target of the fact which points to the xtype whose uri is part of ours (e.g. the whole of a module or the parent of an interface)
+                const std::weak_ptr< XType >* parent = nullptr;
+                /// The version of the cached uri of the parent, or its uri if the parent does not cache it
+                std::uint64_t parent_version = 0;
+                std::string parent_uri;
+                /// The target of the fact which points to the model (if its uri is part of ours) and the properties its uri is built from (domain, name and version)
+                const std::weak_ptr< XType >* model = nullptr;
+                std::array< const nl::json*, 3 > model_properties{};
+                /// The properties which are part of the uri
+                const nl::json* name = nullptr;
+                const nl::json* direction = nullptr;
+            };
+
+            /// Returns a property of an xtype without copying it (nullptr if there is no such property)
+            static const nl::json* property_of(const XType& xtype, const std::string& name);
+
+            /// Returns the uri (rebuilt by build() if the inputs changed)
+            std::string get(const Inputs& inputs, const std::function< std::string() >& build) const;
+
+            /// Returns a number which identifies the current uri among all uris ever cached (rebuilt by build() if the inputs changed)
+            /// NOTE: The xtypes whose uri is built from this one compare the version instead of the whole uri
+            std::uint64_t version(const Inputs& inputs, const std::function< std::string() >& build) const;
+
+        private:
+            /// Rebuilds the uri if the inputs changed (the mutex has to be locked)
+            void update(const Inputs& inputs, const std::function< std::string() >& build) const;
+
+            // NOTE: uri() may be called concurrently (e.g. during a parallel build)
+            mutable std::mutex m_mutex;
+            mutable bool m_valid = false;
+            // The inputs the uri has been built from
+            // NOTE: Xtypes are compared by identity. Holding them weakly keeps their identity from being reused by another one.
+            mutable std::weak_ptr< XType > m_parent;
+            mutable std::uint64_t m_parent_version = 0;
+            mutable std::string m_parent_uri;
+            mutable std::weak_ptr< XType > m_model;
+            mutable std::array< nl::json, 3 > m_model_properties;
+            mutable nl::json m_name;
+            mutable nl::json m_direction;
+            mutable std::string m_uri;
+            mutable std::uint64_t m_version = 0;
+    };
+}
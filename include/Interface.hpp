@@ -0,0 +1,150 @@
+/**
+ * Auto-generated with xtypes_generator types_generator 04/18/2023 11:48:39
+ */
+
+#pragma once
+#include "_Interface.hpp"
+#include "CachedUri.hpp"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+
+namespace xtypes {
+    // Forward Declarations
+
+    class Interface : public _Interface
+    {
+        private:
+            /// The uri of _Interface, which is rebuilt only if the name, the direction or the parent changed
+            /// NOTE: Only the uris of interfaces of modules are cached, the ones of (component) models are not deep anyway
+            CachedUri m_cached_uri;
+            /// Returns the current inputs of the uri of _Interface (the parent module, the name and the direction)
+            CachedUri::Inputs uri_inputs(const std::shared_ptr<Module>& parent) const;
+
+            /// The peers of the facts of a connection relation ('others' or 'from_others') and the positions of their facts
+            /// NOTE: The index is updated by our own functions, which count their modifications. Facts changed through the XType interface are not counted.
+            /// Therefore a hit is only trusted if the fact at its position still points to the peer, and the index is rebuilt if the number or the last of the facts differ.
+            /// Peers are held weakly and compared by owner, so a destroyed peer cannot be mistaken for a new one at the same address.
+            struct PeerIndex
+            {
+                static constexpr std::uint64_t npos = std::numeric_limits< std::uint64_t >::max();
+                std::map< std::weak_ptr< XType >, std::size_t, std::owner_less<> > positions;
+                // The number of modifications made by our own functions and the one the positions are in sync with (npos if they have to be rebuilt)
+                std::uint64_t modifications = 0;
+                std::uint64_t indexed = npos;
+            };
+            PeerIndex m_others_index;
+            PeerIndex m_from_others_index;
+
+            /// Returns the index of the given connection relation (rebuilt if it is out of sync)
+            PeerIndex& synced_index_of(const std::string& relation);
+            /// Returns true if the given connection relation has a fact which points to the peer
+            bool has_peer(const std::string& relation, const XTypePtr& peer);
+            /// Updates the index of the given connection relation after a peer has been added, removed or all peers have been cleared
+            /// NOTE: A removed fact is replaced by the last one, so only the position of the moved peer changes
+            void peer_added(const std::string& relation, const XTypePtr& peer);
+            void peer_removed(const std::string& relation, const XTypePtr& peer, const std::size_t position);
+            void peers_cleared(const std::string& relation);
+            /// Adds a fact which points to the peer to the given connection relation (or updates its edge properties) without scanning the existing facts
+            void append_peer(const std::string& relation, const XTypePtr& peer, const nl::json& properties);
+            /// Removes the fact of the given connection relation which points to the peer (if any) by moving the last fact into its place
+            void remove_peer(const std::string& relation, const XTypePtr& peer);
+
+        public:
+            /// Constructor
+            Interface(const std::string& classname = Interface::classname);
+
+            // Static indentifier
+            /// Useful to lookup the derived classname at compile time
+            static const std::string classname;
+
+            /// Custom URI generator (caches the default implementation in _Interface)
+            std::string uri() const override;
+
+            /// Returns true if interfaces with the given directions can be connected
+            static bool have_compatible_directions(const std::string& from, const std::string& to);
+
+            /// Connects many pairs of interfaces (from, to, connection properties) at once
+            /// Type, direction and multiplicity of all connections are checked in one pass before any of them is added. Connections which exist already (or occur twice) are kept.
+            /// Returns the rejected connections as a list of {"index": <INTEGER>, "from": <uri>, "to": <uri>, "reason": <STRING>}
+            static nl::json connect_all(const std::vector< std::tuple< std::shared_ptr<Interface>, std::shared_ptr<Interface>, nl::json > >& connections);
+
+            /// Removes all connections (in both directions) of the given interfaces
+            /// The time needed is linear in the number of these connections, as long as the interfaces they lead to have only a few connections each (or are given as well).
+            static void disconnect_all(const std::vector< std::shared_ptr<Interface> >& interfaces);
+
+            /// Returns for every interface in from the interfaces in to which it is connectable to (see is_connectable_to())
+            /// The to interfaces are indexed by (InterfaceModel uuid, direction) once, so the time needed is linear in the number of interfaces plus the number of pairs found instead of the product of both lists.
+            /// Interfaces without any connectable counterpart are omitted.
+            static std::map< std::shared_ptr<Interface>, std::vector< std::shared_ptr<Interface> > > find_connectable_pairs(const std::vector< std::shared_ptr<Interface> >& from, const std::vector< std::shared_ptr<Interface> >& to);
+
+            // Method Declarations
+            /// This function returns the domain of the interface
+            virtual std::string get_domain();
+
+            /// Returns the model of which this interface has been instantiated from
+            virtual std::shared_ptr<InterfaceModel> get_type();
+
+            /// This function adds a instance to the InterfaceModel
+            virtual void instance_of(const std::shared_ptr<InterfaceModel> model);
+
+            /// This function adds an interface to either a component or a component model. TODO: Could be templated?
+            virtual void child_of(const std::shared_ptr<XType> parent);
+
+            /// This functions marks this interface as being an alias of another interface. This is used to export internal interfaces of a component model to the exterior.
+            virtual void alias_of(const std::shared_ptr<Interface> interface);
+
+            /// Returns true if this interface is connected to the other interface
+            virtual bool is_connected_to(const std::shared_ptr<Interface> other);
+
+            /// This function connects this interface to another interface. The connection can have properties and the connection can fail if invalid.
+            virtual bool connected_to(const std::shared_ptr<Interface> interface, const nl::json& properties = nl::json::object());
+
+            /// This function disconnects the interface from it's connected interfaces
+            virtual void disconnect();
+
+            /// This function checks if this and the other interface are connectable. That means they have to be compatible AND their current connection status allows further connections
+            virtual bool is_connectable_to(const std::shared_ptr<Interface> other);
+
+            /// This function checks if this and the other interface are compatible by means of connecting them (type, direction, etc).
+            virtual bool is_compatible_with(const std::shared_ptr<Interface> other);
+
+            /// This function returns true if both interfaces share the same type/InterfaceModel
+            virtual bool has_same_type(const std::shared_ptr<Interface> other);
+
+            /// This function returns true if this interface can realize another
+            virtual bool can_realize(const std::shared_ptr<Interface> other);
+
+            /// This returns the  DynamicInterface instance related to this resolved interface if it has one, otherwise nullptr
+            virtual std::shared_ptr<DynamicInterface> get_dynamic_interface();
+
+            /// This function states that this Interface is the realization of an Interface of an Abstract ComponentModel
+            virtual void realizes(const std::shared_ptr<Interface> interface_of_abstract_component_model);
+
+            /// This function removes the realization which has been done with the abstract interface
+            virtual void unrealize();
+
+            /// This function returns true if this interface has already realized an abstract interface
+            virtual bool has_realization(const std::shared_ptr<Interface> other);
+
+            // Overrides for fact setters
+            // NOTE: This keeps the index of the peers in sync
+            void remove_fact(const std::string& relation, XTypeCPtr target);
+            // Overrides for relation setters
+            void add_others(std::shared_ptr<Interface> xtype, const nl::json& props = nl::json{}) override;
+            void add_from_others(std::shared_ptr<Interface> xtype, const nl::json& props = nl::json{}) override;
+            void add_parent(std::shared_ptr<Component> xtype, const nl::json& props = nl::json{}) override;
+            void add_parent(std::shared_ptr<ComponentModel> xtype, const nl::json& props = nl::json{}) override;
+            void add_parent(std::shared_ptr<Module> xtype, const nl::json& props = nl::json{}) override;
+            void add_interfaces_of_abstracts(std::shared_ptr<Interface> xtype, const nl::json& props = nl::json{}) override;
+    };
+
+    using InterfacePtr = std::shared_ptr<Interface>;
+    using InterfaceCPtr = const std::shared_ptr<Interface> ;
+    using ConstInterfacePtr = std::shared_ptr<const Interface> ;
+    using ConstInterfaceCPtr = const std::shared_ptr<const Interface> ;
+}
@@ -0,0 +1,79 @@
+/**
+ * Auto-generated with xtypes_generator types_generator 04/18/2023 11:48:39
+ */
+
+#pragma once
+#include "_Module.hpp"
+#include "BuildPlan.hpp"
+#include "CachedUri.hpp"
+
+
+namespace xtypes {
+    // Forward Declarations
+
+    class Module : public _Module
+    {
+        private:
+            /// The lazy build this module belongs to and its node in there (only set as long as the parts of this module are pending)
+            std::shared_ptr<LazyBuild> m_lazy_build;
+            std::size_t m_lazy_node = BuildNode::npos;
+            /// The uri of _Module, which is rebuilt only if the whole, the model or the name changed
+            CachedUri m_cached_uri;
+
+            /// Returns the current inputs of the uri of _Module (the whole, the model and the name)
+            CachedUri::Inputs uri_inputs() const;
+
+        public:
+            /// Constructor
+            Module(const std::string& classname = Module::classname);
+
+            // Static indentifier
+            /// Useful to lookup the derived classname at compile time
+            static const std::string classname;
+
+            /// Custom URI generator (caches the default implementation in _Module)
+            std::string uri() const override;
+
+            /// Returns a number which changes whenever the uri of this module changes (used by the cached uris of the parts and interfaces)
+            std::uint64_t uri_version() const;
+
+            // Method Declarations
+            /// Returns true if this Module hasn't any parts
+            virtual bool is_atomic();
+
+            /// Search and return a part of the module with the given name
+            virtual std::shared_ptr<Module> get_part(const std::string& name);
+
+            /// This function marks the module as being part of another module
+            virtual void part_of(const std::shared_ptr<Module> whole);
+
+            /// This function applies any pending configuration updates (except global variables) inside the module hierarchy (config_overrides overwrites lower level configuration values)
+            virtual void configure(const nl::json& config_overrides = nl::json::object());
+
+            /// This functions will go through this Module and it's sub-Modules and resolve the global_variables in their configurations
+            virtual void apply_global_variables(const nl::json& global_variables = nl::json::object());
+
+            /// Merges the global variables defined on this Module level into the given global_variables without overriding them, and returns them
+            virtual nl::json get_global_variables(const nl::json& global_variables = nl::json::object());
+
+            /// This function updates this Module to match the (possibly edited) model. Only the submodules, interfaces, aliases and connections which changed are created, removed or rewired. Existing submodules keep their configuration.
+            virtual void rebuild_from(const std::shared_ptr<ComponentModel> model, const std::function<std::shared_ptr<ComponentModel>(const std::shared_ptr<ComponentModel>&, const std::vector<std::shared_ptr<ComponentModel>>&)>& select_implementation = nullptr);
+
+            /// This function creates all pending parts of a lazily built Module (recursively if deep is true)
+            virtual void materialize(const bool& deep = true);
+
+            /// This function deep-copies this Module tree (including interfaces, connections and aliases) into a new toplvl Module with the given name
+            virtual std::shared_ptr<Module> clone(const std::string& new_name);
+
+            /// Marks the parts of this module as pending until they are accessed (used by ComponentModel::build())
+            void defer_parts(const std::shared_ptr<LazyBuild>& lazy_build, const std::size_t node);
+
+            // Overrides for relation setters
+            void add_whole(std::shared_ptr<Module> xtype, const nl::json& props = nl::json{}) override;
+    };
+
+    using ModulePtr = std::shared_ptr<Module>;
+    using ModuleCPtr = const std::shared_ptr<Module> ;
+    using ConstModulePtr = std::shared_ptr<const Module> ;
+    using ConstModuleCPtr = const std::shared_ptr<const Module> ;
+}
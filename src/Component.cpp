@@ -5,6 +5,8 @@
 #include "Interface.hpp"
 #include "InterfaceModel.hpp"
 #include "ComponentModel.hpp"
+#include "Module.hpp"
+#include "BuildPlan.hpp"
 
 using namespace xtypes;
 
@@ -18,6 +20,13 @@ xtypes::Component::Component(const std::string& classname) : _Component(classnam
 // Static identifier
 const std::string xtypes::Component::classname = "xtypes::Component";
 
+// Counts a modification of the models unless the component is a module (modules are built from models, they are not part of them)
+static void count_model_modification_of(const Component& component)
+{
+    if (!dynamic_cast< const Module* >(&component))
+        count_model_modification();
+}
+
 // Method implementations
 // Returns the model of which this component has been instantiated from
 ComponentModelPtr xtypes::Component::get_type()
@@ -41,6 +50,7 @@ void xtypes::Component::part_of(ComponentModelCPtr whole)
 void xtypes::Component::has(InterfaceCPtr interface)
 {
     this->add_interfaces(interface);
+    count_model_modification_of(*this);
 }
 
 // This function returns interface or a nullptr
@@ -59,6 +69,19 @@ InterfaceCPtr xtypes::Component::get_interface(const std::string &name)
     return nullptr;
 }
 
+// Returns for every interface of this component the interfaces of the other component it is connectable to
+std::map<InterfacePtr, std::vector<InterfacePtr>> xtypes::Component::find_connectable_interfaces(ComponentCPtr other)
+{
+    std::vector<InterfacePtr> from, to;
+    if (this->has_facts("interfaces"))
+        for (const auto& [i, _] : this->get_facts("interfaces"))
+            from.push_back(std::static_pointer_cast<Interface>(i.lock()));
+    if (other && other->has_facts("interfaces"))
+        for (const auto& [i, _] : other->get_facts("interfaces"))
+            to.push_back(std::static_pointer_cast<Interface>(i.lock()));
+    return Interface::find_connectable_pairs(from, to);
+}
+
 // Try to match every interface to a model interface by name and type. If such a match cannot be made the interface is added to the list returned together with type matching interfaces.
 std::map<InterfacePtr, std::vector<InterfacePtr>> xtypes::Component::find_nonmatching_interfaces()
 {
@@ -127,6 +150,7 @@ void xtypes::Component::add_model(xtypes::ComponentModelCPtr xtype, const nl::js
         if ((the_facts.size() > 0) && the_facts[0].target.lock()->uuid() == xtype->uuid())
             throw std::invalid_argument("xtypes::Component::add_model: Cannot be an instance of my whole");
     }
+    count_model_modification_of(*this);
     // Finally call the overridden method
     this->_Component::add_model(xtype, props);
 }
@@ -140,6 +164,7 @@ void xtypes::Component::add_whole(xtypes::ComponentModelCPtr xtype, const nl::js
         if ((the_facts.size() > 0) && the_facts[0].target.lock()->uuid() == xtype->uuid())
             throw std::invalid_argument("xtypes::Component::add_whole(): Cannot be part of my own model");
     }
+    count_model_modification_of(*this);
     // Finally call the overridden method
     this->_Component::add_whole(xtype, props);
 }
@@ -11,6 +11,8 @@
 #include "InterfaceModel.hpp"
 #include "ExternalReference.hpp"
 #include "AutoprojReference.hpp"
+#include "BuildPlan.hpp"
+#include "BasicModelStream.hpp"
 #include <xtypes_generator/utils.hpp>
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -24,7 +26,15 @@ namespace fs = boost::filesystem;
 #endif
 using namespace xtypes;
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <deque>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 
 // Constructor
 xtypes::ComponentModel::ComponentModel(const std::string &classname) : _ComponentModel(classname)
@@ -60,6 +70,7 @@ bool xtypes::ComponentModel::derive_domain_from_parts()
     if (!derived_domain.empty())
     {
         this->set_property("domain", derived_domain);
+        count_model_modification();
         return true;
     }
     return false;
@@ -120,6 +131,7 @@ std::map<std::string, ComponentModelPtr> xtypes::ComponentModel::get_all_types()
 // This function sets the superclass of the ComponentModel and updates the type property accordingly
 void xtypes::ComponentModel::subclass_of(const ComponentModelPtr superclass)
 {
+    count_model_modification();
     this->add_model(superclass);
 }
 //// This function checks whether this ComponentModel is a valid implementation of the abstract ComponentModel superclass
@@ -292,6 +304,7 @@ void xtypes::ComponentModel::has(const DynamicInterfacePtr dynamic_interface)
 {
     // Same as has() for interface
     dynamic_interface->add_parent(std::static_pointer_cast<ComponentModel>(shared_from_this()));
+    count_model_modification();
 }
 
 
@@ -348,77 +361,303 @@ ComponentPtr xtypes::ComponentModel::instantiate(const ComponentModelPtr as_part
     return comp;
 }
 
-// This function builds a new module out of the component model spec. It will also build ALL subcomponents.
-ModulePtr xtypes::ComponentModel::build(const std::string& with_name, const std::function< ComponentModelPtr(const ComponentModelPtr&, const std::vector<ComponentModelPtr>&) >& select_implementation)
+// The registry is not meant to be accessed concurrently, so parallel builds serialize instantiation through this lock
+std::mutex& xtypes::registry_mutex()
 {
-    XTypeRegistryPtr reg = this->registry.lock();
-    if (!reg)
+    static std::mutex mutex;
+    return mutex;
+}
+
+// The number of modifications of all models, which invalidates the cached build plans
+// NOTE: A single count is kept for all models, because a modification of e.g. a part model has to invalidate the plans of all models using it
+static std::atomic< std::uint64_t > model_modification_count(0);
+
+void xtypes::count_model_modification()
+{
+    model_modification_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t xtypes::model_modifications()
+{
+    return model_modification_count.load(std::memory_order_relaxed);
+}
+
+// A compiled build plan cached by build()
+// NOTE: The cache must not keep any model alive, so the plan is stored without its references to models and parts. These are held weakly and put back in when the plan gets replayed.
+struct CachedBuildPlan
+{
+    // The number of model modifications (see model_modifications()) when the plan has been compiled
+    std::uint64_t modifications;
+    // The references of the plan in the order of for_each_reference_of()
+    std::vector< std::weak_ptr< XType > > references;
+    // The plan with all of its references reset
+    BuildPlan detached;
+};
+
+// Compiled build plans by model uuid
+static std::mutex build_plans_mutex;
+static std::map< std::size_t, CachedBuildPlan > build_plans;
+
+// Calls visit for every reference of a plan to a model or part
+template < class Visitor >
+static void for_each_reference_of(BuildPlan& plan, Visitor visit)
+{
+    visit(plan.model);
+    for (auto& node : plan.nodes)
     {
-        throw std::invalid_argument("ComponentModel::build(): No registry");
+        visit(node.part);
+        visit(node.model);
+    }
+    for (auto& choice : plan.choices)
+    {
+        visit(choice.abstract_model);
+        for (auto& implementation : choice.implementations)
+            visit(implementation);
+        visit(choice.implementation);
     }
+}
 
-    // First check if we are abstract or not
-    if (this->get_abstract())
+// Stores a plan in the cache of build plans and drops the plans whose models are gone
+static void cache_build_plan(const std::size_t model_uuid, const std::uint64_t modifications, const BuildPlan& plan)
+{
+    CachedBuildPlan cached{modifications, {}, plan};
+    for_each_reference_of(cached.detached, [&cached](auto& reference) {
+        cached.references.push_back(reference);
+        reference.reset();
+    });
+    std::lock_guard< std::mutex > lock(build_plans_mutex);
+    for (auto it = build_plans.begin(); it != build_plans.end();)
+        it = (it->second.references.empty() || it->second.references[0].expired()) ? build_plans.erase(it) : std::next(it);
+    build_plans[model_uuid] = std::move(cached);
+}
+
+// Returns the cached plan of a model if no model has been modified since it has been compiled with the same plan options and all models and parts it refers to still exist
+static std::shared_ptr< const BuildPlan > cached_build_plan_of(const ComponentModelPtr& model, const std::uint64_t modifications, const nl::json& plan_options)
+{
+    std::shared_ptr< BuildPlan > plan;
+    std::vector< std::weak_ptr< XType > > references;
     {
-        // We are abstract, so we need to get resolved first
-        const std::vector< ComponentModelPtr >& implementations(this->get_implementations());
-        if (implementations.size() < 1)
+        std::lock_guard< std::mutex > lock(build_plans_mutex);
+        const auto& it(build_plans.find(model->uuid()));
+        if ((it == build_plans.end()) || (it->second.modifications != modifications) || (it->second.detached.selection_options != plan_options))
+            return nullptr;
+        plan = std::make_shared< BuildPlan >(it->second.detached);
+        references = it->second.references;
+    }
+    std::size_t index = 0;
+    bool complete = true;
+    for_each_reference_of(*plan, [&](auto& reference) {
+        using Target = typename std::decay_t< decltype(reference) >::element_type;
+        reference = std::static_pointer_cast< Target >(references[index++].lock());
+        complete = complete && reference;
+    });
+    if (!complete || (plan->model != model))
+        return nullptr;
+    return plan;
+}
+
+// The report of the last build() which has been asked for one (per thread, so that concurrent builds do not interfere)
+static thread_local std::shared_ptr< const BuildReport > last_build_report;
+
+nl::json xtypes::BuildReport::to_json() const
+{
+    nl::json jphases = nl::json::object();
+    for (const auto &[name, phase] : phases)
+    {
+        jphases[name] = {
+            {"wall_time_ms", phase.wall_time_ms},
+            {"modules", phase.modules},
+            {"interfaces", phase.interfaces},
+            {"aliases", phase.aliases},
+            {"connections", phase.connections},
+            {"instantiations", phase.instantiations},
+            {"warnings", phase.warnings}
+        };
+    }
+    return {{"source", source}, {"total_wall_time_ms", total_wall_time_ms}, {"phases", jphases}};
+}
+
+xtypes::BuildPhaseTimer::BuildPhaseTimer(BuildReport* report, const std::string& phase)
+    : m_phase(report ? &report->phases[phase] : nullptr), m_start(std::chrono::steady_clock::now())
+{
+}
+
+xtypes::BuildPhaseTimer::~BuildPhaseTimer()
+{
+    this->stop();
+}
+
+void xtypes::BuildPhaseTimer::stop()
+{
+    if (!m_phase)
+        return;
+    m_phase->wall_time_ms += std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - m_start).count();
+    m_phase = nullptr;
+}
+
+// Compares two property values. Strings are compared like version strings (number by number), so that v0.10 > v0.9
+static int compare_property_values(const nl::json& a, const nl::json& b)
+{
+    if (a.is_number() && b.is_number())
+    {
+        return (a < b) ? -1 : ((b < a) ? 1 : 0);
+    }
+    if (!a.is_string() || !b.is_string())
+    {
+        return (a < b) ? -1 : ((b < a) ? 1 : 0);
+    }
+    const std::string& sa(a.get_ref< const std::string& >());
+    const std::string& sb(b.get_ref< const std::string& >());
+    std::size_t i = 0, j = 0;
+    while ((i < sa.size()) && (j < sb.size()))
+    {
+        if (std::isdigit(sa[i]) && std::isdigit(sb[j]))
         {
-            throw std::invalid_argument("ComponentModel::build: " + this->uri() + " is abstract but has no implementations");
+            std::size_t ei = i, ej = j;
+            while ((ei < sa.size()) && std::isdigit(sa[ei])) ++ei;
+            while ((ej < sb.size()) && std::isdigit(sb[ej])) ++ej;
+            const unsigned long long na(std::stoull(sa.substr(i, std::min< std::size_t >(ei - i, 18))));
+            const unsigned long long nb(std::stoull(sb.substr(j, std::min< std::size_t >(ej - j, 18))));
+            if (na != nb)
+                return (na < nb) ? -1 : 1;
+            i = ei;
+            j = ej;
+            continue;
         }
-        if ((implementations.size() > 1) && !select_implementation)
+        if (sa[i] != sb[j])
+            return (sa[i] < sb[j]) ? -1 : 1;
+        ++i;
+        ++j;
+    }
+    if (i < sa.size())
+        return 1;
+    if (j < sb.size())
+        return -1;
+    return 0;
+}
+
+// Selects one of the implementations according to a declarative policy
+ComponentModelPtr xtypes::select_implementation_by_policy(const nl::json& policy, const std::vector< ComponentModelPtr >& implementations)
+{
+    if (!policy.is_array())
+    {
+        throw std::invalid_argument("select_implementation_by_policy(): policy has to be a list of criteria");
+    }
+    for (const auto& criterion : policy)
+    {
+        if (!criterion.is_object() || !criterion.contains("property") || !(criterion.contains("prefer") || criterion.contains("order")))
         {
-            throw std::invalid_argument("ComponentModel::build: " + this->uri() + " is abstract and has multiple implementations but callback func is missing");
+            throw std::invalid_argument("select_implementation_by_policy(): invalid criterion " + criterion.dump());
         }
-        ComponentModelPtr impl = implementations[0];
-        // If we can have multiple implementations, we have to ask for a specific one
-        if (implementations.size() > 1)
+    }
+    // Returns true if a is strictly better than b
+    auto is_better = [&](const ComponentModelPtr& a, const ComponentModelPtr& b) -> bool
+    {
+        for (const auto& criterion : policy)
         {
-            impl = select_implementation(std::static_pointer_cast<ComponentModel>(shared_from_this()), implementations);
+            const std::string& property(criterion["property"].get_ref< const std::string& >());
+            const nl::json va(a->has_property(property) ? a->get_property(property) : nl::json());
+            const nl::json vb(b->has_property(property) ? b->get_property(property) : nl::json());
+            if (criterion.contains("prefer"))
+            {
+                // The earlier a value is listed, the better. Values which are not listed are the worst.
+                const nl::json& preferred(criterion["prefer"]);
+                const auto ra(std::find(preferred.begin(), preferred.end(), va) - preferred.begin());
+                const auto rb(std::find(preferred.begin(), preferred.end(), vb) - preferred.begin());
+                if (ra != rb)
+                    return ra < rb;
+            } else {
+                const int result(compare_property_values(va, vb));
+                if (result != 0)
+                    return (criterion["order"] == "lowest") ? (result < 0) : (result > 0);
+            }
         }
-        // Now we can build a module and be done
-        return impl->build(with_name, select_implementation);
+        return false;
+    };
+    ComponentModelPtr best{nullptr};
+    for (const auto& impl : implementations)
+    {
+        if (!best || is_better(impl, best))
+            best = impl;
     }
+    return best;
+}
 
-    // Setup toplvl module (without parent) first
-    ModulePtr module = reg->instantiate<Module>();
-    module->set_properties(this->get_properties(), false);
-    module->set_name(with_name);
-    module->set_configuration(this->get_defaultConfiguration());
-    module->set_unknown_fact_empty("whole");
-    module->instance_of(std::static_pointer_cast<ComponentModel>(shared_from_this()));
+// Extracts the options of ComponentModel::build() which influence the compilation of a build plan
+static nl::json plan_options_of(const nl::json& with_options)
+{
+    nl::json subtree(with_options.value("subtree", nl::json::array()));
+    if (subtree.is_string())
+        subtree = nl::json::array({subtree});
+    return {
+        {"implementation_policy", with_options.value("implementation_policy", nl::json())},
+        {"memoize_selection", with_options.value("memoize_selection", "")},
+        {"max_depth", with_options.value("max_depth", -1)},
+        {"subtree", subtree}
+    };
+}
 
-    // Inherit the interfaces of the model!
-    for (const auto &[i, _] : this->get_facts("interfaces"))
+// Compiles the build plan of a non-abstract model
+std::shared_ptr< const BuildPlan > xtypes::compile_build_plan(const ComponentModelPtr& model, const SelectImplementationFunc& select_implementation, const nl::json& with_options, BuildReport* report)
+{
+    BuildPhaseTimer expansion_timer(report, "expansion");
+    // NOTE: The report may already contain resolution time from before (e.g. the validation of a cached plan)
+    const double resolution_before(report ? report->phases["abstract_resolution"].wall_time_ms : 0.0);
+    std::shared_ptr< BuildPlan > plan(std::make_shared< BuildPlan >());
+    plan->model = model;
+    std::vector< BuildNode >& nodes(plan->nodes);
+
+    // Implementation choices can be made by a policy instead of select_implementation and can be memoized by abstract model (and part)
+    const nl::json policy(with_options.value("implementation_policy", nl::json()));
+    const std::string memoize(with_options.value("memoize_selection", ""));
+    if (!memoize.empty() && (memoize != "model") && (memoize != "part"))
     {
-        // for each interface, get the model and instantiate a clone to be used for the new component instance
-        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
-        const InterfaceModelPtr model(interface->get_type());
-        InterfacePtr clone = reg->instantiate<Interface>();
-        clone->set_properties(interface->get_properties());
-        clone->set_all_unknown_facts_empty();
-        module->has(clone);
-        clone->instance_of(model);
+        throw std::invalid_argument("ComponentModel::build(): memoize_selection has to be either 'model' or 'part'");
     }
+    plan->selection_options = plan_options_of(with_options);
+    std::map< std::pair< std::size_t, std::size_t >, ComponentModelPtr > selected_implementations;
+
+    // The expansion of the part hierarchy can be limited by depth and/or to the subtrees of some parts
+    // Parts which are not expanded are kept as placeholders (with their interfaces but without their parts)
+    const int max_depth(plan->selection_options.at("max_depth").get<int>());
+    const std::vector< std::string > subtrees(plan->selection_options.at("subtree").get< std::vector< std::string > >());
+    std::set< std::string > unresolved_subtrees(subtrees.begin(), subtrees.end());
+    auto is_prefix_of = [](const std::string& prefix, const std::string& path) -> bool
+    {
+        return (path.size() > prefix.size()) && (path.compare(0, prefix.size(), prefix) == 0) && (path[prefix.size()] == '/');
+    };
+    auto shall_expand = [&](const std::string& path, const std::size_t depth) -> bool
+    {
+        if ((max_depth >= 0) && (depth >= static_cast<std::size_t>(max_depth)))
+            return false;
+        if (subtrees.empty())
+            return true;
+        for (const std::string& subtree : subtrees)
+        {
+            // Expand the parts on the way to a subtree as well as the subtree itself
+            if ((path == subtree) || is_prefix_of(path, subtree) || is_prefix_of(subtree, path))
+                return true;
+        }
+        return false;
+    };
 
-    // Early exit: No parts
-    module->set_unknown_fact_empty("parts");
-    if (this->get_facts("parts").size() < 1)
-        return module;
-
-    // We use this map to later wire the modules together
-    std::map< ModulePtr, ComponentPtr > submodule2part;
-    // NOTE: part2submodule would not be injective!!! That means multiple submodules can exist for the same part
-    std::map< InterfacePtr, InterfacePtr > implementation2abstract_interface;
-    // NOTE: abstract2implementation_interface would not be injective!!! That means multiple implementation interfaces can exist for the same abstract interface
-    // Populate initial queue
-    std::deque< std::tuple< ComponentPtr, ModulePtr > > to_visit;
-    for (const auto &[p, _] : this->get_facts("parts"))
-        to_visit.push_back( { std::static_pointer_cast<Component>(p.lock()), module } );
+    // Resolve the part hierarchy first
+    // NOTE: This happens on the calling thread in BFS order, because select_implementation might not be thread-safe (e.g. a python callback)
+    // NOTE: The toplvl parts have depth 1 and the path of a part is the '/' separated list of part names starting at a toplvl part
+    std::deque< std::tuple< ComponentPtr, std::size_t, std::string, std::size_t > > to_visit;
+    if (max_depth != 0)
+    {
+        for (const auto &[p, _] : model->get_facts("parts"))
+        {
+            const ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
+            to_visit.push_back( { part, BuildNode::npos, part->get_name(), 1 } );
+        }
+    }
     while (to_visit.size() > 0)
     {
-        auto [part, parent_module] = to_visit.front();
+        auto [part, parent_index, path, depth] = to_visit.front();
         to_visit.pop_front();
+        unresolved_subtrees.erase(path);
 
         // NOTE: The following code could be part of a Component::build() function
         // Create a submodule from part
@@ -427,201 +666,231 @@ ModulePtr xtypes::ComponentModel::build(const std::string& with_name, const std:
         if (part_model->get_abstract())
         {
             // We have encountered an abstract, which needs to be resolved first
+            BuildPhaseTimer resolution_timer(report, "abstract_resolution");
             const std::vector< ComponentModelPtr >& implementations(part_model->get_implementations());
             if (implementations.size() < 1)
             {
                 throw std::invalid_argument("ComponentModel::build: " + part_model->uri() + " is abstract but has no implementations");
             }
-            if ((implementations.size() > 1) && !select_implementation)
-            {
-                throw std::invalid_argument("ComponentModel::build: " + part_model->uri()
-                        + " is abstract, has multiple implementations but callback func is missing. Cannot build submodule for " + part->uri());
-            }
             ComponentModelPtr impl = implementations[0];
             if (implementations.size() > 1)
             {
-                impl = select_implementation(part_model, implementations);
+                const std::pair< std::size_t, std::size_t > key(part_model->uuid(), (memoize == "part") ? part->uuid() : 0);
+                const auto& it(selected_implementations.find(key));
+                if (!memoize.empty() && (it != selected_implementations.end()))
+                {
+                    impl = it->second;
+                } else if (!policy.is_null()) {
+                    impl = select_implementation_by_policy(policy, implementations);
+                } else if (!select_implementation) {
+                    throw std::invalid_argument("ComponentModel::build: " + part_model->uri()
+                            + " is abstract, has multiple implementations but callback func is missing. Cannot build submodule for " + part->uri());
+                } else {
+                    impl = select_implementation(part_model, implementations);
+                    plan->choices.push_back({part_model, implementations, impl});
+                }
+                if (!memoize.empty())
+                    selected_implementations[key] = impl;
             }
             // An implementation has been chosen, so we set this as the new submodule_model
             submodule_model = impl;
         }
 
-        ModulePtr submodule = reg->instantiate<Module>();
+        const std::size_t index(nodes.size());
+        BuildNode node;
+        node.part = part;
+        node.model = submodule_model;
+        node.parent = parent_index;
+        // Every node belongs to the subtree of a toplvl part. Since we visit in BFS order, the parent has already been visited.
+        node.subtree = (parent_index == BuildNode::npos) ? index : nodes[parent_index].subtree;
+        nodes.push_back(node);
 
-        // Configuration is tricky:
-        // in general the submodule inherits the properties of the part
-        submodule->set_properties(part->get_properties());
-        // but for the configuration this is not so easy (especially for abstract parts)
-        // at first, the component gets the default configuration of its TRUE model
-        nl::json submodule_config = submodule_model->get_defaultConfiguration();
-        // then that default config gets updated by the part config
-        nl::json part_config = part->get_configuration();
-        if (part_config.is_object())
+        // Resolve subparts to be transformed to modules
+        if (submodule_model->is_atomic() || !shall_expand(path, depth))
+            continue;
+        for (const auto &[p, _] : submodule_model->get_facts("parts"))
         {
-            submodule_config.update(part_config, true);
+            const ComponentPtr subpart(std::static_pointer_cast<Component>(p.lock()));
+            to_visit.push_back( { subpart, index, path + "/" + subpart->get_name(), depth + 1 } );
         }
-        submodule->set_configuration(submodule_config);
-
-        submodule->instance_of(submodule_model);
-        submodule->part_of(parent_module);
-        submodule2part[submodule] = part;
-        //std::cout << "submodule: " << submodule->get_name() << "\n";
+    }
+    if (unresolved_subtrees.size() > 0)
+    {
+        throw std::invalid_argument("ComponentModel::build(): Could not find part " + *unresolved_subtrees.begin()
+                + " of " + model->uri() + " (or it is beyond max_depth)");
+    }
 
-        submodule->set_unknown_fact_empty("interfaces");
-        // Inherit the interfaces of the submodule_model (which could be different from the initial abstract part model)
-        for (const auto &[i, _] : submodule_model->get_facts("interfaces"))
+    // The interfaces of a module are cloned from its model in order, so we can address them by their index in the model
+    std::map< ComponentModelPtr, std::map< std::string, std::size_t > > interface_indices;
+    auto index_of_interface = [&](const ComponentModelPtr& of_model, const std::string& name) -> std::size_t
+    {
+        auto it = interface_indices.find(of_model);
+        if (it == interface_indices.end())
         {
-            // for each interface, get the model and instantiate a clone to be used for the new component instance
-            const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
-            const InterfaceModelPtr ifmodel(interface->get_type());
-            InterfacePtr clone = reg->instantiate<Interface>();
-            clone->set_all_unknown_facts_empty();
-            clone->set_properties(interface->get_properties());
-            submodule->has(clone);
-            clone->instance_of(ifmodel);
+            it = interface_indices.emplace(of_model, std::map< std::string, std::size_t >()).first;
+            std::size_t index = 0;
+            for (const auto &[i, _] : of_model->get_facts("interfaces"))
+            {
+                // NOTE: Like get_interface(), the first interface with a given name wins
+                it->second.emplace(i.lock()->get_property("name").get<std::string>(), index++);
+            }
         }
+        const auto& it2(it->second.find(name));
+        return (it2 == it->second.end()) ? BuildNode::npos : it2->second;
+    };
+
+    // NOTE: part2submodule would not be injective!!! That means multiple submodules can exist for the same part
+    // However, the submodules are unique by (part uuid, parent node)
+    std::map< std::pair< std::size_t, std::size_t >, std::size_t > part_and_whole2node;
+    // NOTE: abstract2implementation_interface would not be injective!!! That means multiple implementation interfaces can exist for the same abstract interface
+    // However, per node the mapping from abstract interface uuid to implementation interface is unique, so we index it that way
+    std::vector< std::map< std::size_t, std::size_t > > abstract2implementation_interface(nodes.size());
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        const BuildNode& node(nodes[index]);
+        // NOTE: If there are multiple candidates, the first one wins
+        part_and_whole2node.emplace(std::make_pair(node.part->uuid(), node.parent), index);
 
         // Resolve injective mapping from implementation to abstract interface
-        if (part_model->get_abstract())
+        const ComponentModelPtr part_model(node.part->get_type());
+        if (!part_model->get_abstract())
+            continue;
+        const std::size_t part_model_uuid(part_model->uuid());
+        std::set< std::size_t > mapped_implementation_interfaces;
+        for (const auto &implementation_model_interface : node.model->get_interfaces())
         {
-            for (const auto &implementation_model_interface : submodule_model->get_interfaces())
+            const std::size_t implementation_interface(index_of_interface(node.model, implementation_model_interface->get_name()));
+            // Until here, we are safe
+            for (const auto &[i,_] : implementation_model_interface->get_facts("interfaces_of_abstracts"))
             {
-                const InterfacePtr implementation_interface(submodule->get_interface(implementation_model_interface->get_name()));
-                // Until here, we are safe
-                for (const auto &[i,_] : implementation_model_interface->get_facts("interfaces_of_abstracts"))
+                const InterfacePtr abstract_model_interface(std::static_pointer_cast<Interface>(i.lock()));
+                // Here we have to make sure, that the abstract_model is equal to the part_model
+                if (abstract_model_interface->get_facts("parent")[0].target.lock()->uuid() != part_model_uuid)
+                    continue;
+                // Ok, we have found an abstract_model_interface which should be existing as well at the part
+                const InterfacePtr abstract_interface(node.part->get_interface(abstract_model_interface->get_name()));
+                // This is a safety check to ensure injectivity
+                if (!mapped_implementation_interfaces.insert(implementation_interface).second)
                 {
-                    const InterfacePtr abstract_model_interface(std::static_pointer_cast<Interface>(i.lock()));
-                    // Here we have to make sure, that the abstract_model is equal to the part_model
-                    if (abstract_model_interface->get_facts("parent")[0].target.lock()->uri() != part_model->uri())
-                        continue;
-                    // Ok, we have found an abstract_model_interface which should be existing as well at the part
-                    const InterfacePtr abstract_interface(part->get_interface(abstract_model_interface->get_name()));
-                    // This is a safety check to ensure injectivity
-                    if (implementation2abstract_interface.count(implementation_interface))
-                    {
-                        throw std::runtime_error("ComponentModel::build(): implementation2abstract_interface not injective!");
-                    }
-                    implementation2abstract_interface[implementation_interface] = abstract_interface;
+                    throw std::runtime_error("ComponentModel::build(): implementation2abstract_interface not injective!");
                 }
+                // NOTE: emplace keeps the first implementation interface found for an abstract interface
+                abstract2implementation_interface[index].emplace(abstract_interface->uuid(), implementation_interface);
             }
         }
+    }
+
+    // Lookup of the submodule interface counterpart of a part interface
+    auto resolve_submodule_interface = [&](const std::size_t index, const InterfacePtr& part_if) -> std::size_t
+    {
+        // Remap abstract interfaces to the implementation interfaces if needed
+        if (nodes[index].part->get_type()->get_abstract())
+        {
+            const auto& it(abstract2implementation_interface[index].find(part_if->uuid()));
+            return (it == abstract2implementation_interface[index].end()) ? BuildNode::npos : it->second;
+        }
+        return index_of_interface(nodes[index].model, part_if->get_name());
+    };
 
-        // Resolve subparts to be transformed to modules
-        submodule->set_unknown_fact_empty("parts");
-        if (submodule_model->is_atomic())
-            continue;
-        for (const auto &[p, _] : submodule_model->get_facts("parts"))
-            to_visit.push_back( { std::static_pointer_cast<Component>(p.lock()), submodule } );
+    expansion_timer.stop();
+    if (report)
+    {
+        // The expansion phase does not include the abstract resolution done by this compilation
+        report->phases["expansion"].wall_time_ms -= report->phases["abstract_resolution"].wall_time_ms - resolution_before;
     }
 
-    // Resolve alias interfaces
-    for (const auto &[submodule, part] : submodule2part)
+    // Index all alias interfaces of the wholes by (whole uuid, original interface uuid)
+    BuildPhaseTimer alias_timer(report, "alias_resolution");
+    // NOTE: The whole of a part is the model of the parent node (or the model itself for toplvl parts)
+    std::map< std::pair< std::size_t, std::size_t >, std::vector< InterfacePtr > > original2alias_interfaces;
+    std::set< std::size_t > indexed_wholes;
+    for (const auto& node : nodes)
     {
-        const ComponentModelPtr whole(std::static_pointer_cast<ComponentModel>(part->get_facts("whole")[0].target.lock()));
-        const ModulePtr parent_module(std::static_pointer_cast<Module>(submodule->get_facts("whole")[0].target.lock()));
-        // We have two cases here: abstract and non-abstract model of part
-        const ComponentModelPtr part_model(part->get_type());
-        const ComponentModelPtr submodule_model(submodule->get_type());
+        const ComponentModelPtr whole(node.parent == BuildNode::npos ? model : nodes[node.parent].model);
+        const std::size_t whole_uuid(whole->uuid());
+        if (!indexed_wholes.insert(whole_uuid).second)
+            continue;
         for (const auto &[i,_] : whole->get_facts("interfaces"))
         {
-            // Alias interface pair of whole and module counter part
+            // Alias interface of whole
             const InterfacePtr alias_interface(std::static_pointer_cast<Interface>(i.lock()));
             // Resolve original rel. If there is none, we have nothing to do.
             if (alias_interface->get_facts("original").size() < 1)
                 continue;
+            const XTypePtr original_interface(alias_interface->get_facts("original")[0].target.lock());
+            original2alias_interfaces[{whole_uuid, original_interface->uuid()}].push_back(alias_interface);
+        }
+    }
+
+    // Resolve alias interfaces
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        const ComponentPtr& part(nodes[index].part);
+        const std::size_t parent(nodes[index].parent);
+        const ComponentModelPtr whole(parent == BuildNode::npos ? model : nodes[parent].model);
+        const std::size_t whole_uuid(whole->uuid());
+        for (const auto &[i,_] : part->get_facts("interfaces"))
+        {
             // Original interface of part
-            const InterfacePtr original_interface(std::static_pointer_cast<Interface>(alias_interface->get_facts("original")[0].target.lock()));
-            // Check if this interface is pointing to the same part
-            const ComponentPtr parent(std::static_pointer_cast<Component>(original_interface->get_facts("parent")[0].target.lock()));
-            if (part->uri() != parent->uri())
-                continue;
-            // The alias interface twin can always be found by name
-            InterfacePtr alias_interface_twin(parent_module->get_interface(alias_interface->get_name()));
-            if (!alias_interface_twin)
-            {
-                std::cerr << "ComponentModel::build(): WARNING: Could not resolve alias interface " << alias_interface->uri()
-                    << " of whole " << whole->uri()
-                    << " at parent module " << parent_module->uri()
-                    << "\n";
+            const InterfacePtr original_interface(std::static_pointer_cast<Interface>(i.lock()));
+            // Check if this interface has been exported by the whole
+            const auto& it(original2alias_interfaces.find({whole_uuid, original_interface->uuid()}));
+            if (it == original2alias_interfaces.end())
                 continue;
-            }
-            // We have found a match of alias and original interface! So now we resolve the counterparts.
-            if (part_model->get_abstract())
+            for (const InterfacePtr& alias_interface : it->second)
             {
-                // abstract case: we cannot find the counterparts by name, but we have to find the mapping from abstract interface to implementation interface via the models
-                // We have to find an implementation interface which is an interface of submodule and is mapped to the original interface
-                InterfacePtr original_interface_twin = nullptr;
-                for (const auto &[x,_] : submodule->get_facts("interfaces"))
-                {
-                    const InterfacePtr candidate_if(std::static_pointer_cast<Interface>(x.lock()));
-                    if (implementation2abstract_interface.count(candidate_if) < 1)
-                        continue;
-                    if (implementation2abstract_interface[candidate_if]->uri() == original_interface->uri())
-                    {
-                        original_interface_twin = candidate_if;
-                        break;
-                    }
-                }
-                if (!original_interface_twin)
+                // The alias interface twin can always be found by name
+                const std::size_t alias_interface_twin(index_of_interface(whole, alias_interface->get_name()));
+                if (alias_interface_twin == BuildNode::npos)
                 {
-                    std::cerr << "ComponentModel::build(): WARNING: Could not resolve abstract interface " << original_interface->uri()
-                        << " of part " << part->uri()
-                        << " at submodule " << submodule->uri()
+                    if (report)
+                        report->phases["alias_resolution"].warnings++;
+                    std::cerr << "ComponentModel::build(): WARNING: Could not resolve alias interface " << alias_interface->uri()
+                        << " of whole " << whole->uri()
                         << "\n";
                     continue;
                 }
-                alias_interface_twin->alias_of(original_interface_twin);
-            } else {
+                // We have found a match of alias and original interface! So now we resolve the counterparts.
+                // abstract case: we cannot find the counterparts by name, but we have to find the mapping from abstract interface to implementation interface via the models
                 // non-abstract case: for every interface of whole we find an original interface in part, by name we find the corresponding interfaces in parent_module and submodule
-                InterfacePtr original_interface_twin(submodule->get_interface(original_interface->get_name()));
-                if (!original_interface_twin)
+                const std::size_t original_interface_twin(resolve_submodule_interface(index, original_interface));
+                if (original_interface_twin == BuildNode::npos)
                 {
-                    std::cerr << "ComponentModel::build(): WARNING: Could not resolve interface " << original_interface->uri()
+                    if (report)
+                        report->phases["alias_resolution"].warnings++;
+                    std::cerr << "ComponentModel::build(): WARNING: Could not resolve "
+                        << (part->get_type()->get_abstract() ? "abstract interface " : "interface ") << original_interface->uri()
                         << " of part " << part->uri()
-                        << " at submodule " << submodule->uri()
+                        << " at submodule model " << nodes[index].model->uri()
                         << "\n";
                     continue;
                 }
-                alias_interface_twin->alias_of(original_interface_twin);
+                plan->aliases.push_back({{parent, alias_interface_twin}, {index, original_interface_twin}});
             }
         }
     }
 
+    alias_timer.stop();
+
     // Wire modules together according to their counterpart connections
-    // NOTE: Here we can use the names to look up the module interfaces
-    for (const auto &[submodule, part] : submodule2part)
+    BuildPhaseTimer wiring_timer(report, "wiring");
+    for (std::size_t index = 0; index < nodes.size(); ++index)
     {
-        // Lookup the whole for later ...
-        const XTypePtr whole(submodule->get_facts("whole")[0].target.lock());
+        const ComponentPtr& part(nodes[index].part);
         for (const auto &[i, _] : part->get_facts("interfaces"))
         {
             const InterfacePtr part_if(std::static_pointer_cast<Interface>(i.lock()));
-            InterfacePtr submodule_if;
-            // Remap abstract interfaces to the implementation interfaces if needed
-            if (part->get_type()->get_abstract())
-            {
-                for (const auto &[x,_] : submodule->get_facts("interfaces"))
-                {
-                    const InterfacePtr candidate_if(std::static_pointer_cast<Interface>(x.lock()));
-                    if (implementation2abstract_interface.count(candidate_if) < 1)
-                        continue;
-                    if (implementation2abstract_interface[candidate_if]->uri() == part_if->uri())
-                    {
-                        submodule_if = candidate_if;
-                        break;
-                    }
-                }
-            } else {
-                submodule_if = submodule->get_interface(part_if->get_name());
-            }
+            const std::size_t submodule_if(resolve_submodule_interface(index, part_if));
 
-            if (!submodule_if)
+            if (submodule_if == BuildNode::npos)
             {
+                if (report)
+                    report->phases["wiring"].warnings++;
                 // Only produce a warning here. However, if there is a connection involved, this will turn into an error!!
                 // That means, that unconnected ports which cannot be mapped are just ignored.
                 std::cerr << "ComponentModel::build(): WARNING: Could not map interface " << part_if->uri()
                     << " of part " << part->uri()
-                    << " to an interface of submodule " + submodule->uri()
+                    << " to an interface of submodule model " + nodes[index].model->uri()
                     << "\n";
             }
 
@@ -629,822 +898,2772 @@ ModulePtr xtypes::ComponentModel::build(const std::string& with_name, const std:
             {
                 const InterfacePtr other_part_if(std::static_pointer_cast<Interface>(i2.lock()));
                 const ComponentPtr other_part(std::static_pointer_cast<Component>(other_part_if->get_facts("parent")[0].target.lock()));
-                ModulePtr other_submodule = nullptr;
-                for (const auto &[other_submodule_candidate, other_part_candidate] : submodule2part)
-                {
-                    // The uris of the candidate part and and the part have to match
-                    if (other_part_candidate->uri() != other_part->uri())
-                        continue;
-                    // The whole of the candidate submodule has to match the submodule whole
-                    if (other_submodule_candidate->get_facts("whole")[0].target.lock()->uri() != whole->uri())
-                        continue;
-                    // NOTE: We do not wanna exclude self connections
-                    other_submodule = other_submodule_candidate;
-                    break;
-                }
-                if (!other_submodule)
+                // The other submodule has to be instantiated from the other part and has to share the whole with the submodule
+                // NOTE: We do not wanna exclude self connections
+                const auto& it(part_and_whole2node.find({other_part->uuid(), nodes[index].parent}));
+                if (it == part_and_whole2node.end())
                 {
                     // NOTE: This is a true error!
                     throw std::runtime_error("ComponentModel::build(): Could not find submodule for " + other_part->uri());
                 }
-                InterfacePtr other_submodule_if;
-                // Remap abstract interfaces to the implementation interfaces if needed
-                if (other_part->get_type()->get_abstract())
-                {
-                    for (const auto &[x,_] : other_submodule->get_facts("interfaces"))
-                    {
-                        const InterfacePtr candidate_if(std::static_pointer_cast<Interface>(x.lock()));
-                        if (implementation2abstract_interface.count(candidate_if) < 1)
-                            continue;
-                        if (implementation2abstract_interface[candidate_if]->uri() == other_part_if->uri())
-                        {
-                            other_submodule_if = candidate_if;
-                            break;
-                        }
-                    }
-                } else {
-                    other_submodule_if = other_submodule->get_interface(other_part_if->get_name());
-                }
-                if (!other_submodule_if)
+                const std::size_t other_index(it->second);
+                const std::size_t other_submodule_if(resolve_submodule_interface(other_index, other_part_if));
+                if (other_submodule_if == BuildNode::npos)
                 {
                     // NOTE: This is a true error, since we cannot resolve a CONNECTED target interface
                     throw std::runtime_error("ComponentModel::build(): Could not map target interface " + other_part_if->uri()
                             + " of part " + other_part->uri()
-                            + " to an interface of submodule " + other_submodule->uri());
+                            + " to an interface of submodule model " + nodes[other_index].model->uri());
                 }
-                if (!submodule_if)
+                if (submodule_if == BuildNode::npos)
                 {
                     // NOTE: This is a true error, since we cannot resolve a CONNECTED source interface
                     throw std::runtime_error("ComponentModel::build(): Could not map source interface " + part_if->uri()
                             + " of part " + part->uri()
-                            + " to an interface of submodule " + submodule->uri());
+                            + " to an interface of submodule model " + nodes[index].model->uri());
                 }
-                //std::cout << "connection: " << submodule_if->get_name() << " -> " << other_submodule_if->get_name() << "\n";
-                submodule_if->connected_to(other_submodule_if, conn_props);
+                plan->connections.push_back({{index, submodule_if}, {other_index, other_submodule_if}, conn_props});
             }
         }
     }
 
-    return module;
+    return plan;
 }
 
-// Returns all interfaces which match a given type (if set) and a given name (if set).
-std::vector<InterfacePtr> xtypes::ComponentModel::get_interfaces(const InterfaceModelPtr with_type, const std::string& with_name)
+// Prints the connections rejected by Interface::connect_all()
+void xtypes::warn_about_rejected_connections(const nl::json& rejected)
 {
-    std::vector<InterfacePtr> matches;
-    for (const auto &[i, _] : this->get_facts("interfaces"))
-    {
-        const xtypes::InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
-        if (with_type && with_type->uuid() != interface->get_type()->uuid())
-        {
-            continue;
-        }
-        if (!with_name.empty() && with_name != interface->get_name())
-        {
-            continue;
-        }
-        matches.push_back(interface);
-    }
-    return matches;
+    for (const auto& connection : rejected)
+        std::cerr << "ComponentModel::build(): Could not connect " << connection["from"].get<std::string>() << " to " << connection["to"].get<std::string>() << ": " << connection["reason"].get<std::string>() << "\n";
 }
 
-// This function removes interfaces by it's name
-void xtypes::ComponentModel::remove_interface(const std::string &name)
+// Creates the module and its interface clones of a node without linking them to any shared object
+void xtypes::materialize_build_node(XTypeRegistryPtr reg, const BuildNode& node, BuiltNode& built)
 {
-    auto matches = get_interfaces(nullptr, name);
-    for (const auto& match : matches)
-        remove_fact("interfaces", match);
-}
+    ModulePtr submodule = instantiate_locked<Module>(reg);
+
+    // Configuration is tricky:
+    // in general the submodule inherits the properties of the part
+    submodule->set_properties(node.part->get_properties());
+    // but for the configuration this is not so easy (especially for abstract parts)
+    // at first, the component gets the default configuration of its TRUE model
+    nl::json submodule_config = node.model->get_defaultConfiguration();
+    // then that default config gets updated by the part config
+    nl::json part_config = node.part->get_configuration();
+    if (part_config.is_object())
+    {
+        submodule_config.update(part_config, true);
+    }
+    submodule->set_configuration(submodule_config);
 
-// This functions resolves any interfaces of inner parts which do not match any of the parts' model interfaces and a list of possible future matches.
-std::map<InterfacePtr, std::vector<InterfacePtr>> xtypes::ComponentModel::find_nonmatching_part_interfaces()
-{
-    std::map<InterfacePtr, std::vector<InterfacePtr>> result;
-    for (const auto& [p,_] : this->get_facts("parts"))
+    submodule->set_unknown_fact_empty("interfaces");
+    // Inherit the interfaces of the submodule_model (which could be different from the initial abstract part model)
+    for (const auto &[i, _] : node.model->get_facts("interfaces"))
     {
-        const xtypes::ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
-        const std::map<InterfacePtr, std::vector<InterfacePtr>> nonmatching_part_interfaces(part->find_nonmatching_interfaces());
-        result.insert(nonmatching_part_interfaces.begin(), nonmatching_part_interfaces.end());
+        // for each interface, get the model and instantiate a clone to be used for the new component instance
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        InterfacePtr clone = instantiate_locked<Interface>(reg);
+        clone->set_all_unknown_facts_empty();
+        clone->set_properties(interface->get_properties());
+        submodule->has(clone);
+        // NOTE: The model is shared, so instance_of() is deferred
+        built.interfaces.push_back({clone, interface->get_type()});
     }
-    return result;
+    submodule->set_unknown_fact_empty("parts");
+    built.module = submodule;
 }
 
-// Go to every part and its interfaces and call disconnect
-void xtypes::ComponentModel::disconnect_parts()
+// Prepares the lazy build of a plan
+std::shared_ptr< LazyBuild > xtypes::prepare_lazy_build(const std::shared_ptr< const BuildPlan >& plan)
 {
-    for (const auto &[part, _] : this->get_facts("parts"))
-        for (const auto &[partInterface, _] : part.lock()->get_facts("interfaces"))
-            std::static_pointer_cast<Interface>(partInterface.lock())->disconnect();
+    std::shared_ptr< LazyBuild > lazy(std::make_shared< LazyBuild >());
+    lazy->plan = plan;
+    const std::size_t n_slots(plan->nodes.size() + 1);
+    lazy->children.resize(n_slots);
+    lazy->aliases.resize(n_slots);
+    lazy->connections.resize(n_slots);
+    lazy->interfaces.resize(n_slots);
+    for (std::size_t index = 0; index < plan->nodes.size(); ++index)
+        lazy->children[lazy->slot(plan->nodes[index].parent)].push_back(index);
+    // Aliases are resolved by the module owning the alias interface, connections by the whole of the connected modules
+    for (std::size_t index = 0; index < plan->aliases.size(); ++index)
+        lazy->aliases[lazy->slot(plan->aliases[index].first.first)].push_back(index);
+    for (std::size_t index = 0; index < plan->connections.size(); ++index)
+        lazy->connections[lazy->slot(plan->nodes[std::get<0>(plan->connections[index]).first].parent)].push_back(index);
+    return lazy;
 }
 
-// This method exports a component model to the DROCK BasicModel Json format
-std::string xtypes::ComponentModel::export_to_basic_model()
+// Executes a build plan and returns the toplvl module
+static ModulePtr execute_build_plan(XTypeRegistryPtr reg, const std::shared_ptr< const BuildPlan >& plan_ptr, const std::string& with_name, const nl::json& with_options, BuildReport* report)
 {
-    nl::json data;
-    data["name"] = get_name();
-    data["domain"] = get_domain();
-    data["uri"] = uri();
-    data["types"] = nl::json::array();
-    for (const auto& supermodel : get_types())
+    const BuildPlan& plan(*plan_ptr);
+    const std::vector< BuildNode >& nodes(plan.nodes);
+    BuildPhaseTimer instantiation_timer(report, "instantiation");
+
+    // Setup toplvl module (without parent) first
+    BuiltNode toplvl;
+    ModulePtr module = reg->instantiate<Module>();
+    module->set_properties(plan.model->get_properties(), false);
+    module->set_name(with_name);
+    module->set_configuration(plan.model->get_defaultConfiguration());
+    module->set_unknown_fact_empty("whole");
+    module->instance_of(plan.model);
+    toplvl.module = module;
+
+    // Inherit the interfaces of the model!
+    for (const auto &[i, _] : plan.model->get_facts("interfaces"))
     {
-        data["types"].push_back({{"name", supermodel->get_property("name")}, {"version", supermodel->get_property("version")}});
+        // for each interface, get the model and instantiate a clone to be used for the new component instance
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        const InterfaceModelPtr model(interface->get_type());
+        InterfacePtr clone = reg->instantiate<Interface>();
+        clone->set_properties(interface->get_properties());
+        clone->set_all_unknown_facts_empty();
+        module->has(clone);
+        clone->instance_of(model);
+        toplvl.interfaces.push_back({clone, model});
     }
-    if (get_abstract())
+    if (report)
     {
-        data["implementations"] = nl::json::array();
-        this->set_unknown_fact_empty("implementations");
-        for (const auto &model : get_implementations())
-        {
-            data["implementations"].push_back({{"name", model->get_property("name")}, {"domain", model->get_property("domain")}, {"version", model->get_property("version")}});
-        }
+        BuildReport::Phase& phase(report->phases["instantiation"]);
+        phase.modules++;
+        phase.interfaces += toplvl.interfaces.size();
+        phase.instantiations += 1 + toplvl.interfaces.size();
     }
 
-    this->set_unknown_fact_empty("abstracts");
-    for (const auto &supermodel : get_abstracts())
-    {
-        data["abstracts"].push_back({{"name", supermodel->get_property("name")}, {"domain", supermodel->get_property("domain")}, {"version", supermodel->get_property("version")}});
-    }
+    // Early exit: No parts
+    module->set_unknown_fact_empty("parts");
+    if (nodes.size() < 1)
+        return module;
 
-    //data["interfaces_of_abstracts"] = nl::json::array();
-    for (const auto &[ti, _] : this->get_facts("interfaces"))
+    // In lazy mode, the parts will be created when they are accessed
+    if (with_options.value("lazy", false))
     {
-        const InterfacePtr this_interface(std::static_pointer_cast<Interface>(ti.lock()));
-        this_interface->set_unknown_fact_empty("interfaces_of_abstracts");
-        for (const auto &[ai, _] : this_interface->get_facts("interfaces_of_abstracts"))
+        std::shared_ptr< LazyBuild > lazy(prepare_lazy_build(plan_ptr));
+        for (const auto &[clone, _] : toplvl.interfaces)
+            lazy->interfaces[lazy->slot(BuildNode::npos)].push_back(clone);
+        module->defer_parts(lazy, BuildNode::npos);
+        return module;
+    }
+
+    // Materialize the submodules
+    // NOTE: This step only touches the newly created modules and interfaces, so independent subtrees can be expanded in parallel
+    std::vector< BuiltNode > built(nodes.size());
+    const bool in_parallel(with_options.value("parallel", false));
+    if (in_parallel)
+    {
+        // Collect the subtrees rooted at the toplvl parts
+        std::map< std::size_t, std::vector< std::size_t > > subtrees;
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+            subtrees[nodes[index].subtree].push_back(index);
+        std::vector< const std::vector< std::size_t >* > work;
+        for (const auto &[_, subtree] : subtrees)
+            work.push_back(&subtree);
+
+        const int max_threads(with_options.value("max_threads", 0));
+        std::size_t n_threads(max_threads > 0 ? max_threads : std::max(1u, std::thread::hardware_concurrency()));
+        n_threads = std::min(n_threads, work.size());
+
+        std::atomic< std::size_t > next_subtree(0);
+        std::vector< std::exception_ptr > errors(n_threads);
+        std::vector< std::thread > workers;
+        for (std::size_t t = 0; t < n_threads; ++t)
         {
-            const InterfacePtr abstract_interface(std::static_pointer_cast<Interface>(ai.lock()));
-            const ComponentModelPtr abstract(std::static_pointer_cast<ComponentModel>(abstract_interface->get_facts("parent").at(0).target.lock()));
-            nl::json ioa;
-            ioa["abstract_model_name"] = abstract->get_name(); 
-            ioa["abstract_interface_direction"] = abstract_interface->get_direction();
-            ioa["abstract_interface_name"] = abstract_interface->get_name(); 
-            ioa["abstract_interface_type"] = abstract_interface->get_type()->get_property("name");
-            data["interfaces_of_abstracts"].push_back(ioa);
+            workers.emplace_back([&, t]() {
+                try
+                {
+                    for (std::size_t w = next_subtree++; w < work.size(); w = next_subtree++)
+                        for (const std::size_t index : *work[w])
+                            materialize_build_node(reg, nodes[index], built[index]);
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                }
+            });
         }
-    
+        for (auto& worker : workers)
+            worker.join();
+        for (const auto& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+    } else {
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+            materialize_build_node(reg, nodes[index], built[index]);
     }
-    if(this->has_facts("configured_for"))
+
+    // Link the submodules to their models and wholes
+    // NOTE: This touches shared objects (models, parent modules) and is therefore done serially in BFS order
+    for (std::size_t index = 0; index < nodes.size(); ++index)
     {
-    for (const auto &[h, _] : this->get_facts("configured_for"))
+        const ModulePtr& submodule(built[index].module);
+        submodule->instance_of(nodes[index].model);
+        submodule->part_of(nodes[index].parent == BuildNode::npos ? module : built[nodes[index].parent].module);
+        //std::cout << "submodule: " << submodule->get_name() << "\n";
+        for (const auto &[clone, ifmodel] : built[index].interfaces)
+            clone->instance_of(ifmodel);
+    }
+    if (report)
     {
-        const xtypes::ComponentModelPtr hardware_model(std::static_pointer_cast<ComponentModel>(h.lock()));
-
-        data["configured_for"]
-            .push_back({{"name", hardware_model->get_property("name")},{"version", hardware_model->get_property("version")}, {"uri", hardware_model->uri()}});
+        // NOTE: The nodes might have been materialized in parallel, so we count afterwards
+        BuildReport::Phase& phase(report->phases["instantiation"]);
+        for (const auto& b : built)
+        {
+            phase.modules++;
+            phase.interfaces += b.interfaces.size();
+            phase.instantiations += 1 + b.interfaces.size();
+        }
     }
+    instantiation_timer.stop();
+
+    auto interface_of = [&](const BuildInterfaceRef& ref) -> const InterfacePtr&
+    {
+        return ((ref.first == BuildNode::npos) ? toplvl : built[ref.first]).interfaces[ref.second].first;
+    };
+
+    // Resolve alias interfaces
+    {
+        BuildPhaseTimer alias_timer(report, "alias_resolution");
+        for (const auto &[alias, original] : plan.aliases)
+            interface_of(alias)->alias_of(interface_of(original));
+        if (report)
+            report->phases["alias_resolution"].aliases += plan.aliases.size();
     }
-    nl::json version;
-    version["name"] = get_version();
-    version["date"] = get_date();
-    version["designedBy"] = get_designedBy();
-    version["projectName"] = get_projectName();
-    version["maturity"] = get_maturity();
-    version["can_have_parts"] = get_can_have_parts();
-    version["abstract"] = get_abstract();
-    if (const nl::json defaultConfiguration = get_defaultConfiguration(); !defaultConfiguration.empty())
+
+    // Wire modules together according to their counterpart connections
+    BuildPhaseTimer wiring_timer(report, "wiring");
+    std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > > connections;
+    connections.reserve(plan.connections.size());
+    for (const auto &[from, to, conn_props] : plan.connections)
+        connections.emplace_back(interface_of(from), interface_of(to), conn_props);
+    const nl::json rejected(Interface::connect_all(connections));
+    warn_about_rejected_connections(rejected);
+    if (report)
     {
-        version["defaultConfiguration"] = defaultConfiguration;
+        report->phases["wiring"].connections += plan.connections.size() - rejected.size();
+        report->phases["wiring"].warnings += rejected.size();
     }
 
-    if (this->has_facts("external_references")) {
-        for (const auto &[p, e] : this->get_facts("external_references"))
+    return module;
+}
+
+// The models a build depends on (indexed by uri)
+struct BuildClosure
+{
+    std::map< std::string, ComponentModelPtr > models;
+    std::map< std::string, InterfaceModelPtr > interface_models;
+};
+
+// Incremental 64bit FNV-1a hash, which (unlike std::hash) is stable across runs and platforms
+struct StableHash
+{
+    std::uint64_t value = 14695981039346656037ull;
+
+    void add(const std::string& data)
+    {
+        for (const unsigned char c : data)
         {
-            const xtypes::ExternalReferencePtr reference(std::static_pointer_cast<ExternalReference>(p.lock()));
-            nl::json referenceData = reference->get_properties();
-            referenceData["optional"] = e.contains("optional") ? e["optional"].get<bool>() : true;
-            version["external_references"].push_back(referenceData);
+            value ^= c;
+            value *= 1099511628211ull;
         }
+        // Terminate every field, so that ("ab", "c") and ("a", "bc") differ
+        value ^= 0xff;
+        value *= 1099511628211ull;
     }
 
-    if (const nl::json self_data = this->get_data(); !self_data.empty()) 
+    std::string hex() const
     {
-        version["data"] = self_data;
+        std::ostringstream out;
+        out << std::hex << std::setw(16) << std::setfill('0') << value;
+        return out.str();
     }
+};
 
-    for (const auto &[p, _] : this->get_facts("parts"))
+// Computes the key of the build cache of a model. The key is a content hash of the closure of the model (all models reachable by parts and implementations) and the plan options.
+// NOTE: The content is fed into the hash directly instead of being collected into a JSON document first, because this is on the startup path of every cached build
+static std::string build_cache_key_of(const ComponentModelPtr& model, const nl::json& with_options, BuildClosure& closure)
+{
+    // NOTE: Models which have not been fully set up yet may lack some facts
+    static const std::vector< Fact > no_facts;
+    StableHash hash;
+    auto add_interface = [&](const InterfacePtr& interface)
     {
-        const xtypes::ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
-        nl::json partData;
-        partData["name"] = part->get_name();
-        partData["alias"] = part->get_alias();
-        partData["model"] = nl::json();
-        const xtypes::ComponentModelPtr target(part->get_type());
-        partData["model"]["name"] = target->get_name();
-        partData["model"]["domain"] = target->get_domain();
-        partData["model"]["version"] = target->get_version(); // NOTE: added \" to satisfy assertion(type == type) in xtype when importing
-        if (part->has_property("configuration") && !part->get_property("configuration").empty())
+        const InterfaceModelPtr interface_model(interface->get_type());
+        closure.interface_models[interface_model->uri()] = interface_model;
+        hash.add(interface->uri());
+        hash.add(interface->get_properties().dump());
+        hash.add(interface_model->uri());
+        for (const std::string relation : {"original", "others", "interfaces_of_abstracts"})
         {
-            nl::json config;
-            if (part->get_property("configuration").is_string() && !part->get_property("configuration").get<std::string>().empty())
-                config = xtypes::parseJson(part->get_property("configuration").get<std::string>(), "xtypes::ComponentModel::exportToBasicModelJSON()->configuration");
-            else
-                config = part->get_property("configuration");
-            if (config.contains("name"))
+            hash.add(relation);
+            if (!interface->has_facts(relation))
+                continue;
+            for (const auto &[t, props] : interface->get_facts(relation))
             {
-                config["name"] = part->get_name();
-                version["components"]["configuration"]["nodes"].push_back(config);
+                hash.add(t.lock()->uri());
+                hash.add(props.dump());
             }
         }
-        partData["interface_aliases"] = nl::json();
-        for (auto &[i, _] : part->get_facts("interfaces"))
+    };
+
+    std::deque< ComponentModelPtr > to_visit{model};
+    while (to_visit.size() > 0)
+    {
+        const ComponentModelPtr current(to_visit.front());
+        to_visit.pop_front();
+        if (!closure.models.emplace(current->uri(), current).second)
+            continue;
+        hash.add("model");
+        hash.add(current->uri());
+        hash.add(current->get_properties().dump());
+        for (const auto &[i, _] : (current->has_facts("interfaces") ? current->get_facts("interfaces") : no_facts))
+            add_interface(std::static_pointer_cast<Interface>(i.lock()));
+        for (const auto &[p, _] : (current->has_facts("parts") ? current->get_facts("parts") : no_facts))
         {
-            InterfacePtr interface = std::static_pointer_cast<Interface>(i.lock());
-            nl::json edgeData;
-            // Store the part interface alias
-            partData["interface_aliases"][interface->get_name()] = interface->get_alias();
-            edgeData["from"]["name"] = part->get_name();
-            edgeData["from"]["interface"] = interface->get_name();
-            edgeData["from"]["domain"] = interface->get_domain();
-            for (auto &[otherInterface, otherInterfaceProps] : interface->get_facts("others"))
+            const ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
+            const ComponentModelPtr part_model(part->get_type());
+            hash.add("part");
+            hash.add(part->uri());
+            hash.add(part->get_properties().dump());
+            hash.add(part_model->uri());
+            for (const auto &[i, _] : (part->has_facts("interfaces") ? part->get_facts("interfaces") : no_facts))
+                add_interface(std::static_pointer_cast<Interface>(i.lock()));
+            to_visit.push_back(part_model);
+        }
+        for (const auto &[d, _] : (current->has_facts("dynamic_interfaces") ? current->get_facts("dynamic_interfaces") : no_facts))
+        {
+            const DynamicInterfacePtr dynamic_interface(std::static_pointer_cast<DynamicInterface>(d.lock()));
+            const InterfaceModelPtr interface_model(dynamic_interface->get_type());
+            closure.interface_models[interface_model->uri()] = interface_model;
+            hash.add("dynamic_interface");
+            hash.add(dynamic_interface->uri());
+            hash.add(dynamic_interface->get_properties().dump());
+            hash.add(interface_model->uri());
+        }
+        if (current->get_abstract())
+        {
+            for (const auto& implementation : current->get_implementations())
             {
-                const std::vector<xtypes::Fact> &parent_component = otherInterface.lock()->get_facts("parent");
-                const xtypes::ComponentPtr otherPart = std::static_pointer_cast<Component>(parent_component[0].target.lock());
-                edgeData["to"]["name"] = otherPart->get_name();
-                edgeData["to"]["interface"] = std::static_pointer_cast<Interface>(otherInterface.lock())->get_name();
-                edgeData["to"]["domain"] = std::static_pointer_cast<Interface>(otherInterface.lock())->get_domain();
-
-                // Handle edge properties
-                const std::vector<std::string> excludes = {"configuration"};
-                for (auto &[prop, val] : otherInterfaceProps.items())
-                {
-                    std::vector<std::string>::const_iterator it = std::find_if(excludes.begin(), excludes.end(), [&prop = prop](const std::string &excluded)
-                                                                               { return excluded == prop; });
-                    if (it != excludes.end())
-                        continue;
-                    edgeData[prop] = val;
-                }
-
-                // Handle edge configuration
-                if (otherInterfaceProps.contains("configuration") && !otherInterfaceProps["configuration"].empty())
-                {
-                    nl::json config;
-                    if (otherInterfaceProps["configuration"].is_string() && !otherInterfaceProps["configuration"].get<std::string>().empty())
-                        config = xtypes::parseJson(otherInterfaceProps["configuration"].get<std::string>(), "xtypes::ComponentModel::exportToBasicModelJSON()->configuration2");
-                    else
-                        config = otherInterfaceProps["configuration"];
-                    if (otherInterfaceProps.contains("name"))
-                    {
-                        config["name"] = otherInterfaceProps["name"];
-                    }
-                    version["components"]["configuration"]["edges"].push_back(config);
-                }
-                version["components"]["edges"].push_back(edgeData);
+                hash.add("implementation");
+                hash.add(implementation->uri());
+                to_visit.push_back(implementation);
             }
         }
-        version["components"]["nodes"].push_back(partData);
     }
+    hash.add(plan_options_of(with_options).dump());
+    return hash.hex();
+}
 
-    for (const auto &[i, _] : this->get_facts("interfaces"))
+// Stores a built module tree in the build cache
+// NOTE: The file is written under a temporary name first, so concurrent readers never see a partial file
+// NOTE: The module tree has to be materialized completely
+static void save_to_build_cache(const fs::path& path, const ModulePtr& module, const std::vector< BuildPlan::Choice >& choices)
+{
+    // Collect the tree in BFS order
+    std::vector< ModulePtr > modules{module};
+    std::map< const XType*, std::size_t > module2index{{module.get(), 0}};
+    std::map< const XType*, std::size_t > interface2index;
+    nl::json model_uris = nl::json::array();
+    std::map< std::string, std::size_t > model_indices;
+    auto index_of_model = [&](const XTypePtr& model) -> std::size_t
     {
-        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
-        nl::json props = interface->get_properties();
-        // Special case: domain and type
-        props["domain"] = interface->get_domain();
-        props["type"] = interface->get_type()->get_property("name");
-        if (interface->has_relation("original") && (interface->get_facts("original").size() > 0))
+        const auto& it(model_indices.emplace(model->uri(), model_uris.size()));
+        if (it.second)
+            model_uris.push_back(model->uri());
+        return it.first->second;
+    };
+
+    nl::json jmodules = nl::json::array();
+    nl::json jinterfaces = nl::json::array();
+    std::vector< InterfacePtr > interfaces;
+    for (std::size_t index = 0; index < modules.size(); ++index)
+    {
+        const ModulePtr current(modules[index]);
+        const std::size_t parent(index == 0 ? BuildNode::npos : module2index.at(current->get_facts("whole")[0].target.lock().get()));
+        jmodules.push_back({(index == 0) ? -1 : static_cast<long long>(parent), index_of_model(current->get_type()), current->get_properties()});
+        for (const auto &[i, _] : current->get_facts("interfaces"))
         {
-            props["linkToNode"] = std::static_pointer_cast<ComponentModel>(interface->get_facts("original")[0].target.lock()->get_facts("parent")[0].target.lock())->get_name();
-            props["linkToInterface"] = std::static_pointer_cast<ComponentModel>(interface->get_facts("original")[0].target.lock())->get_name();
+            const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+            interface2index[interface.get()] = interfaces.size();
+            interfaces.push_back(interface);
+            jinterfaces.push_back({index, index_of_model(interface->get_type()), interface->get_properties()});
+        }
+        for (const auto &[p, _] : current->get_facts("parts"))
+        {
+            module2index[p.lock().get()] = modules.size();
+            modules.push_back(std::static_pointer_cast<Module>(p.lock()));
         }
-        version["interfaces"].push_back(props);
     }
 
-    for (const auto &[i, _] : this->get_facts("dynamic_interfaces"))
+    nl::json jaliases = nl::json::array();
+    nl::json jconnections = nl::json::array();
+    for (std::size_t index = 0; index < interfaces.size(); ++index)
     {
-        const DynamicInterfacePtr interface(std::static_pointer_cast<DynamicInterface>(i.lock()));
-        nl::json props = interface->get_properties();
-        // Special case: domain and type
-        props["domain"] = interface->get_domain();
-        props["type"] = interface->get_type()->get_property("name");
-        /// original is a featured we might add later for dynamic interfaces as well
-        version["dynamic_interfaces"].push_back(props);
+        for (const auto &[o, _] : interfaces[index]->get_facts("original"))
+        {
+            const auto& it(interface2index.find(o.lock().get()));
+            if (it != interface2index.end())
+                jaliases.push_back({index, it->second});
+        }
+        for (const auto &[o, conn_props] : interfaces[index]->get_facts("others"))
+        {
+            const auto& it(interface2index.find(o.lock().get()));
+            if (it != interface2index.end())
+                jconnections.push_back({index, it->second, conn_props});
+        }
     }
 
-    data["versions"].push_back(version);
-    return data.dump();
+    nl::json jchoices = nl::json::array();
+    for (const auto& choice : choices)
+    {
+        nl::json implementations = nl::json::array();
+        for (const auto& implementation : choice.implementations)
+            implementations.push_back(implementation->uri());
+        jchoices.push_back({choice.abstract_model->uri(), implementations, choice.implementation->uri()});
+    }
+
+    const nl::json cached = {
+        {"format", 1},
+        {"choices", jchoices},
+        {"models", model_uris},
+        {"modules", jmodules},
+        {"interfaces", jinterfaces},
+        {"aliases", jaliases},
+        {"connections", jconnections}
+    };
+    try
+    {
+        fs::create_directories(path.parent_path());
+        const fs::path tmp_path(path.string() + ".tmp" + std::to_string(reinterpret_cast<std::uintptr_t>(module.get())));
+        {
+            std::ofstream out(tmp_path.string(), std::ios::binary);
+            const std::vector< std::uint8_t > data(nl::json::to_cbor(cached));
+            out.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!out)
+                throw std::runtime_error("Could not write " + tmp_path.string());
+        }
+        fs::rename(tmp_path, path);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "ComponentModel::build(): WARNING: Could not store build cache " << path.string() << ": " << e.what() << "\n";
+    }
 }
 
-std::vector<ComponentModelPtr> xtypes::ComponentModel::import_from_basic_model(const std::string &serialized_model, const XTypeRegistryPtr &registry)
+// Loads a built module tree from the build cache. Returns nullptr if there is no (valid) entry or if select_implementation makes different choices.
+static ModulePtr load_from_build_cache(XTypeRegistryPtr reg, const fs::path& path, const BuildClosure& closure, const SelectImplementationFunc& select_implementation, const std::string& with_name, BuildReport* report)
 {
-    std::vector<ComponentModelPtr> result;
-    std::map<std::string, ComponentModelPtr> part_models;
-    nl::json data = xtypes::parseJson(serialized_model, "xtypes::ComponentModel::import_from_basic_model");
-    if (!data.contains("name"))
+    nl::json cached;
     {
-        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'name' in " + data.dump());
+        std::ifstream in(path.string(), std::ios::binary);
+        if (!in)
+            return nullptr;
+        const std::vector< std::uint8_t > data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        cached = nl::json::from_cbor(data, true, false);
     }
-    const std::string name(data["name"].get<std::string>());
-    if (!data.contains("domain"))
+    if (cached.is_discarded() || !cached.is_object() || (cached.value("format", 0) != 1))
     {
-        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'domain' in " + data.dump());
+        if (report)
+            report->phases["cache_lookup"].warnings++;
+        std::cerr << "ComponentModel::build(): WARNING: Ignoring invalid build cache " << path.string() << "\n";
+        return nullptr;
     }
-    const std::string domain(data["domain"].get<std::string>());
 
-    // Resolve supermodels
-    std::vector<ComponentModelPtr> supermodels;
-    if (data.contains("types"))
+    try
     {
-        for (const auto& t : data["types"])
+        auto model_of = [&](const std::string& uri) -> ComponentModelPtr
         {
-            nl::json props = nl::json{{"name", t["name"]}, {"version", t["version"]}, {"domain", domain}};
-            ComponentModel dummy;
-            dummy.set_properties(props);
-            ComponentModelPtr supermodel = std::static_pointer_cast<ComponentModel>(registry->load_by_uri(dummy.uri()));
-            if (!supermodel)
+            const auto& it(closure.models.find(uri));
+            if (it == closure.models.end())
+                throw std::runtime_error("Unknown model " + uri);
+            return it->second;
+        };
+
+        // The cached tree is only valid as long as select_implementation makes the same choices again
+        for (const auto& choice : cached.at("choices"))
+        {
+            if (!select_implementation)
+                return nullptr;
+            std::vector< ComponentModelPtr > implementations;
+            for (const auto& uri : choice.at(1))
+                implementations.push_back(model_of(uri));
+            const ComponentModelPtr impl(select_implementation(model_of(choice.at(0)), implementations));
+            if (!impl || (impl->uri() != choice.at(2).get<std::string>()))
+                return nullptr;
+        }
+
+        // Resolve the models
+        const nl::json& model_uris(cached.at("models"));
+        std::vector< XTypePtr > models;
+        models.reserve(model_uris.size());
+        for (const auto& juri : model_uris)
+        {
+            const std::string uri(juri.get<std::string>());
+            const auto& it(closure.models.find(uri));
+            if (it != closure.models.end())
             {
-                supermodel = registry->instantiate<ComponentModel>();
-                supermodel->set_properties(props);
+                models.push_back(it->second);
+                continue;
             }
-            supermodels.push_back(supermodel);
+            const auto& it2(closure.interface_models.find(uri));
+            if (it2 == closure.interface_models.end())
+                throw std::runtime_error("Unknown model " + uri);
+            models.push_back(it2->second);
         }
-    }
 
-    // Resolve configured_for
-    std::vector<ComponentModelPtr> configured_for;
-    if (data.contains("configured_for"))
-    {
-        for (const auto &h : data["configured_for"])
+        // Allocate all modules and interfaces at once
+        const nl::json& jmodules(cached.at("modules"));
+        const nl::json& jinterfaces(cached.at("interfaces"));
+        std::vector< ModulePtr > modules;
+        std::vector< InterfacePtr > interfaces;
+        modules.reserve(jmodules.size());
+        interfaces.reserve(jinterfaces.size());
         {
-            nl::json props = nl::json{{"name", h["name"]}, {"version", h["version"]}, {"uri", h["uri"]}};
-            ComponentModelPtr hardware = std::static_pointer_cast<ComponentModel>(registry->load_by_uri(h["uri"]));
-            if (!hardware)
+            std::lock_guard< std::mutex > lock(registry_mutex());
+            for (std::size_t index = 0; index < jmodules.size(); ++index)
+                modules.push_back(reg->instantiate<Module>());
+            for (std::size_t index = 0; index < jinterfaces.size(); ++index)
+                interfaces.push_back(reg->instantiate<Interface>());
+        }
+        if (modules.size() < 1)
+            throw std::runtime_error("No toplvl module");
+
+        for (std::size_t index = 0; index < modules.size(); ++index)
+        {
+            const nl::json& jmodule(jmodules[index]);
+            const ModulePtr& module(modules[index]);
+            module->set_properties(jmodule.at(2), false);
+            module->set_unknown_fact_empty("interfaces");
+            module->set_unknown_fact_empty("parts");
+            if (index == 0)
             {
-                hardware = registry->instantiate<ComponentModel>();
-                hardware->set_properties(props);
+                module->set_name(with_name);
+                module->set_unknown_fact_empty("whole");
+            } else {
+                module->part_of(modules.at(jmodule.at(0).get<std::size_t>()));
             }
-            configured_for.push_back(hardware);
+            module->instance_of(std::static_pointer_cast<ComponentModel>(models.at(jmodule.at(1).get<std::size_t>())));
+        }
+        for (std::size_t index = 0; index < interfaces.size(); ++index)
+        {
+            const nl::json& jinterface(jinterfaces[index]);
+            const InterfacePtr& interface(interfaces[index]);
+            interface->set_all_unknown_facts_empty();
+            interface->set_properties(jinterface.at(2));
+            modules.at(jinterface.at(0).get<std::size_t>())->has(interface);
+            interface->instance_of(std::static_pointer_cast<InterfaceModel>(models.at(jinterface.at(1).get<std::size_t>())));
         }
+        for (const auto& jalias : cached.at("aliases"))
+            interfaces.at(jalias.at(0).get<std::size_t>())->alias_of(interfaces.at(jalias.at(1).get<std::size_t>()));
+        // NOTE: The connections are checked again, so that a corrupted or tampered file cannot create invalid connections
+        std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > > connections;
+        connections.reserve(cached.at("connections").size());
+        for (const auto& jconnection : cached.at("connections"))
+            connections.emplace_back(interfaces.at(jconnection.at(0).get<std::size_t>()), interfaces.at(jconnection.at(1).get<std::size_t>()), jconnection.at(2));
+        const nl::json rejected(Interface::connect_all(connections));
+        if (rejected.size() > 0)
+            throw std::runtime_error("Invalid connection from " + rejected[0]["from"].get<std::string>() + " to " + rejected[0]["to"].get<std::string>() + ": " + rejected[0]["reason"].get<std::string>());
+        if (report)
+        {
+            BuildReport::Phase& phase(report->phases["cache_lookup"]);
+            phase.modules += modules.size();
+            phase.interfaces += interfaces.size();
+            phase.aliases += cached.at("aliases").size();
+            phase.connections += cached.at("connections").size();
+            phase.instantiations += modules.size() + interfaces.size();
+        }
+        return modules[0];
+    }
+    catch (const std::exception& e)
+    {
+        if (report)
+            report->phases["cache_lookup"].warnings++;
+        std::cerr << "ComponentModel::build(): WARNING: Ignoring invalid build cache " << path.string() << ": " << e.what() << "\n";
+        return nullptr;
     }
+}
 
-    // Create model(s)
-    if (!data.contains("versions"))
+// This function builds a new module out of the component model spec. It will also build ALL subcomponents.
+ModulePtr xtypes::ComponentModel::build(const std::string& with_name, const std::function< ComponentModelPtr(const ComponentModelPtr&, const std::vector<ComponentModelPtr>&) >& select_implementation, const nl::json& with_options)
+{
+    XTypeRegistryPtr reg = this->registry.lock();
+    if (!reg)
     {
-        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'versions' in " + data.dump());
+        throw std::invalid_argument("ComponentModel::build(): No registry");
     }
-    for (const auto &v : data["versions"])
+
+    // First check if we are abstract or not
+    if (this->get_abstract())
     {
-        if (!v.contains("name"))
+        // We are abstract, so we need to get resolved first
+        const std::vector< ComponentModelPtr >& implementations(this->get_implementations());
+        if (implementations.size() < 1)
         {
-            std::cerr << "ComponentModel::import_from_basic_model(): Could not find 'name' in versions " << v.dump() << ". Ignoring it.\n";
-            continue;
+            throw std::invalid_argument("ComponentModel::build: " + this->uri() + " is abstract but has no implementations");
+        }
+        const nl::json policy(with_options.value("implementation_policy", nl::json()));
+        if ((implementations.size() > 1) && !select_implementation && policy.is_null())
+        {
+            throw std::invalid_argument("ComponentModel::build: " + this->uri() + " is abstract and has multiple implementations but callback func is missing");
+        }
+        ComponentModelPtr impl = implementations[0];
+        // If we can have multiple implementations, we have to ask for a specific one
+        if (implementations.size() > 1)
+        {
+            if (!policy.is_null())
+                impl = select_implementation_by_policy(policy, implementations);
+            else
+                impl = select_implementation(std::static_pointer_cast<ComponentModel>(shared_from_this()), implementations);
         }
-        const std::string version(v["name"].get<std::string>());
+        // Now we can build a module and be done
+        return impl->build(with_name, select_implementation, with_options);
+    }
 
-        // Setup the properties
-        nl::json props;
-        // At first, set second lvl properties
-        props = v;
-        // Then override by toplvl properties
-        props.update(data);
-        // ... and set version (since this collides with toplvl name)
-        props["version"] = version;
+    const ComponentModelPtr self(std::static_pointer_cast<ComponentModel>(shared_from_this()));
 
-        // Create new model with specific version
-        ComponentModelPtr model = registry->instantiate<ComponentModel>();
-        model->set_all_unknown_facts_empty();
-        model->set_properties(props, false);
-        // Attach supermodels
-        for (auto& supermodel : supermodels)
+    // Record a report if requested
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    std::shared_ptr< BuildReport > report(with_options.value("report", false) ? std::make_shared< BuildReport >() : nullptr);
+    auto finish = [&](const ModulePtr& module) -> ModulePtr
+    {
+        if (report)
         {
-            // .. to subclass_of relation
-            model->subclass_of(supermodel);
+            report->total_wall_time_ms = std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - start).count();
+            last_build_report = report;
         }
+        return module;
+    };
 
-        // Attach configured_for
-        for (auto &hardware : configured_for)
+    // Try to load the module from the persistent build cache, which is keyed by the content hash of the model closure
+    const std::string cache_dir(with_options.value("cache_dir", ""));
+    BuildClosure closure;
+    fs::path cache_path;
+    if (!cache_dir.empty())
+    {
+        BuildPhaseTimer lookup_timer(report.get(), "cache_lookup");
+        cache_path = fs::path(cache_dir) / (build_cache_key_of(self, with_options, closure) + ".cbor");
+        const ModulePtr cached(load_from_build_cache(reg, cache_path, closure, select_implementation, with_name, report.get()));
+        if (cached)
         {
-            // .. to configured_for relation
-            model->add_configured_for(hardware);
+            lookup_timer.stop();
+            if (report)
+                report->source = "cache_dir";
+            return finish(cached);
         }
+    }
 
-        // Handle defaultConfigurations
-        if (v.contains("defaultConfiguration"))
-            model->set_defaultConfiguration(v["defaultConfiguration"]);
-
-        // Resolve/create external references
-        if (v.contains("external_references")) {
-            assert(v["external_references"].is_array());
-            for (const auto &eRefIt : v["external_references"])
-            {
-                // TODO: Actually, the ExternalReference has to be looked up FIRST (by load_missing_external_reference or such) and only created if not found
-                AutoprojReferencePtr eRef = registry->instantiate<AutoprojReference>();
-                eRef->set_properties(eRefIt);
-                // Afterwards we annotate the model with the external reference
-                model->annotate_with((AutoprojReferencePtr)eRef, eRefIt["optional"]);
-            }
+    // Cached plans are valid as long as no model has been modified
+    // NOTE: The count is taken before compiling, so a modification during the compilation invalidates the plan as well
+    const bool use_cached_plan(with_options.value("cache_plan", false));
+    const std::uint64_t modifications(model_modifications());
+    std::shared_ptr< const BuildPlan > plan;
+    if (use_cached_plan)
+    {
+        {
+            BuildPhaseTimer lookup_timer(report.get(), "cache_lookup");
+            plan = cached_build_plan_of(self, modifications, plan_options_of(with_options));
         }
-
-        // Handle deprecated repository
-        if (v.contains("repository"))
-            throw std::runtime_error("The 'repository' property of ComponentModel is deprecated. Please use the ExternalReference relation instead.");
-        // Handle assemblyData
-        if (domain == "ASSEMBLY" && v.contains("assemblyData"))
-            model->set_data(v["assemblyData"]);
-        else if (domain == "SOFTWARE" && v.contains("softwareData"))
-            model->set_data(v["softwareData"]);
-        else if (domain == "ELECTRONICS" && v.contains("electronicsData"))
-            model->set_data(v["electronicsData"]);
-        else if (domain == "MECHANICS" && v.contains("mechanicsData"))
-            model->set_data(v["mechanicsData"]);
-        else if (domain == "COMPUTATION" && v.contains("computationData"))
-            model->set_data(v["computationData"]);
-        else if (v.contains("data"))
-            model->set_data(v["data"]);
-
-        // Handling subcomponents/parts and their connections
-        bool error_occurred = false;
-        std::vector<ComponentPtr> parts;
-        if (v.contains("components"))
+        // A cached plan can only be replayed if select_implementation makes the same choices again
+        // NOTE: If all choices match, the choice points of the plan are the same as well
+        if (plan && (plan->choices.size() > 0))
         {
-            // Handling parts
-            if (v["components"].contains("nodes"))
+            BuildPhaseTimer resolution_timer(report.get(), "abstract_resolution");
+            if (!select_implementation)
             {
-                for (const auto &part : v["components"]["nodes"])
+                plan = nullptr;
+            } else {
+                for (const auto& choice : plan->choices)
                 {
-                    const std::string partName(part["name"].get<std::string>());
-                    const std::string partModelName(part["model"]["name"].get<std::string>());
-                    const std::string partModelDomain(part["model"]["domain"].get<std::string>());
-                    const std::string partModelVersion(part["model"]["version"].get<std::string>());
-
-                    // First lookup component model in cache
-                    ComponentModelPtr partModel{nullptr};
-                    const std::string lookup(partModelName + partModelDomain + partModelVersion);
-                    if (part_models.count(lookup))
-                    {
-                        partModel = part_models.at(lookup);
-                    }
-                    else
-                    {
-                        // ... if not found, call provided function to search for a matching part model
-                        ComponentModel dummy;
-                        dummy.set_properties(part["model"]);
-                        partModel = std::static_pointer_cast<ComponentModel>(registry->load_by_uri(dummy.uri()));
-                        // and place it into cache
-                        if (partModel)
-                        {
-                            part_models[lookup] = partModel;
-                        }
-                    }
-                    // If the model has not been found, ignore it
-                    if (!partModel)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model: Could not load model " + partModelName + " for part " + partName << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-
-                    // Create the part (and set all inner facts to be empty, not unknown)
-                    ComponentPtr p = partModel->instantiate(model, partName, true);
-                    if (!p)
+                    const ComponentModelPtr impl(select_implementation(choice.abstract_model, choice.implementations));
+                    if (!impl || (impl->uuid() != choice.implementation->uuid()))
                     {
-                        std::cerr << "ComponentModel::import_from_basic_model: Could instantiate part " + partName << "\n";
-                        error_occurred = true;
+                        plan = nullptr;
                         break;
                     }
-                    // Set alias (if given)
-                    if (part.contains("alias"))
-                    {
-                        p->set_alias(part["alias"]);
-                    }
-                    // Set interface aliases
-                    if (part.contains("interface_aliases"))
-                    {
-                        for (const auto&[ifName, ifAlias] : part["interface_aliases"].items())
-                        {
-                            xtypes::InterfacePtr pi = p->get_interface(ifName);
-                            if (!pi)
-                            {
-                                std::cerr << "ComponentModel::import_from_basic_model: Could not find part interface " + ifName + " to set alias\n";
-                                error_occurred = true;
-                                continue;
-                            }
-                            pi->set_alias(ifAlias);
-                        }
-                    }
-                    parts.push_back(p);
                 }
             }
+        }
+    }
+    if (plan)
+    {
+        if (report)
+            report->source = "cached_plan";
+    } else {
+        plan = compile_build_plan(self, select_implementation, with_options, report.get());
+        if (use_cached_plan)
+            cache_build_plan(this->uuid(), modifications, *plan);
+    }
+    const ModulePtr module(execute_build_plan(reg, plan, with_name, with_options, report.get()));
+    // NOTE: Lazy builds are not stored, because storing would materialize the whole tree
+    if (!cache_path.empty() && !with_options.value("lazy", false))
+    {
+        BuildPhaseTimer store_timer(report.get(), "cache_store");
+        save_to_build_cache(cache_path, module, plan->choices);
+    }
+    return finish(module);
+}
 
-            // Handle connections
-            if (v["components"].contains("edges"))
-            {
-                for (const auto &conn : v["components"]["edges"])
-                {
-                    // Check and parse info for source part
-                    if (!conn.contains("from"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: 'from' entry missing in " << conn.dump() << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    if (!conn["from"].contains("name"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: 'name' entry missing in " << conn["from"].dump() << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    const std::string fromPartName(conn["from"]["name"].get<std::string>());
-                    if (!conn["from"].contains("interface"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: interface entry in 'from' for part " << fromPartName << " is missing.\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    const std::string fromPartInterfaceName(conn["from"]["interface"].get<std::string>());
-                    std::string fromPartInterfaceDomain(std::string("NOT_SET"));
-                    if (conn["from"].contains("domain"))
-                    {
-                        fromPartInterfaceDomain = conn["from"]["domain"].get<std::string>();
-                    }
+// Returns the report of the last build() with 'report': true on the calling thread
+nl::json xtypes::ComponentModel::get_last_build_report()
+{
+    return last_build_report ? last_build_report->to_json() : nl::json::object();
+}
+
+// Forgets all build plans which have been cached by build()
+void xtypes::ComponentModel::forget_build_plans()
+{
+    std::lock_guard< std::mutex > lock(build_plans_mutex);
+    build_plans.clear();
+}
+
+// Returns all interfaces which match a given type (if set) and a given name (if set).
+std::vector<InterfacePtr> xtypes::ComponentModel::get_interfaces(const InterfaceModelPtr with_type, const std::string& with_name)
+{
+    std::vector<InterfacePtr> matches;
+    for (const auto &[i, _] : this->get_facts("interfaces"))
+    {
+        const xtypes::InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        if (with_type && with_type->uuid() != interface->get_type()->uuid())
+        {
+            continue;
+        }
+        if (!with_name.empty() && with_name != interface->get_name())
+        {
+            continue;
+        }
+        matches.push_back(interface);
+    }
+    return matches;
+}
+
+// This function removes interfaces by it's name
+void xtypes::ComponentModel::remove_interface(const std::string &name)
+{
+    count_model_modification();
+    auto matches = get_interfaces(nullptr, name);
+    for (const auto& match : matches)
+        remove_fact("interfaces", match);
+}
+
+// This functions resolves any interfaces of inner parts which do not match any of the parts' model interfaces and a list of possible future matches.
+std::map<InterfacePtr, std::vector<InterfacePtr>> xtypes::ComponentModel::find_nonmatching_part_interfaces()
+{
+    std::map<InterfacePtr, std::vector<InterfacePtr>> result;
+    for (const auto& [p,_] : this->get_facts("parts"))
+    {
+        const xtypes::ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
+        const std::map<InterfacePtr, std::vector<InterfacePtr>> nonmatching_part_interfaces(part->find_nonmatching_interfaces());
+        result.insert(nonmatching_part_interfaces.begin(), nonmatching_part_interfaces.end());
+    }
+    return result;
+}
+
+// Returns for every interface of the inner parts the interfaces of the other parts it is connectable to
+std::map<InterfacePtr, std::vector<InterfacePtr>> xtypes::ComponentModel::find_connectable_part_interfaces()
+{
+    std::vector<InterfacePtr> interfaces;
+    if (this->has_facts("parts"))
+        for (const auto &[part, _] : this->get_facts("parts"))
+            if (part.lock()->has_facts("interfaces"))
+                for (const auto &[partInterface, _] : part.lock()->get_facts("interfaces"))
+                    interfaces.push_back(std::static_pointer_cast<Interface>(partInterface.lock()));
+    // NOTE: All part interfaces are matched against each other in one pass. Pairs of interfaces of the same part are dropped afterwards.
+    std::map<InterfacePtr, std::vector<InterfacePtr>> result(Interface::find_connectable_pairs(interfaces, interfaces));
+    for (auto it = result.begin(); it != result.end();)
+    {
+        const XTypePtr parent(it->first->get_facts("parent")[0].target.lock());
+        auto& others(it->second);
+        others.erase(std::remove_if(others.begin(), others.end(),
+                    [&parent](const InterfacePtr& other) { return other->get_facts("parent")[0].target.lock() == parent; }),
+                others.end());
+        it = others.empty() ? result.erase(it) : std::next(it);
+    }
+    return result;
+}
+
+// Go to every part and its interfaces and call disconnect
+void xtypes::ComponentModel::disconnect_parts()
+{
+    // NOTE: All interfaces are disconnected at once, so the connections between parts are removed without searching for their reverse edges
+    std::vector<InterfacePtr> interfaces;
+    for (const auto &[part, _] : this->get_facts("parts"))
+        for (const auto &[partInterface, _] : part.lock()->get_facts("interfaces"))
+            interfaces.push_back(std::static_pointer_cast<Interface>(partInterface.lock()));
+    Interface::disconnect_all(interfaces);
+}
+
+// Calls fn for every index below count on up to max_threads threads (default: number of cores) and rethrows the first exception afterwards
+static void for_each_in_parallel(const std::size_t count, const int max_threads, const std::function< void(const std::size_t) >& fn)
+{
+    std::size_t n_threads(max_threads > 0 ? max_threads : std::max(1u, std::thread::hardware_concurrency()));
+    n_threads = std::min(n_threads, count);
+    std::atomic< std::size_t > next(0);
+    std::vector< std::exception_ptr > errors(n_threads);
+    std::vector< std::thread > workers;
+    for (std::size_t t = 0; t < n_threads; ++t)
+    {
+        workers.emplace_back([&, t]() {
+            try
+            {
+                for (std::size_t index = next++; index < count; index = next++)
+                    fn(index);
+            }
+            catch (...)
+            {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    for (const auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+// Returns the facts of a relation or none if they are unknown.
+// NOTE: Unknown facts are not made known (empty) here, so that exporting does not modify a model and can be done concurrently
+static std::vector<xtypes::Fact> known_facts_of(XType& xtype, const std::string& relation)
+{
+    if (!xtype.has_facts(relation))
+        return {};
+    return xtype.get_facts(relation);
+}
+
+// Returns the toplvl entries of a model in the DROCK BasicModel Json format (without the versions)
+static nl::json basic_model_header_of(ComponentModel& model)
+{
+    nl::json data;
+    data["name"] = model.get_name();
+    data["domain"] = model.get_domain();
+    data["uri"] = model.uri();
+    data["types"] = nl::json::array();
+    for (const auto& supermodel : model.get_types())
+    {
+        data["types"].push_back({{"name", supermodel->get_property("name")}, {"version", supermodel->get_property("version")}});
+    }
+    if (model.get_abstract())
+    {
+        data["implementations"] = nl::json::array();
+        for (const auto &[i, _] : known_facts_of(model, "implementations"))
+        {
+            const ComponentModelPtr implementation(std::static_pointer_cast<ComponentModel>(i.lock()));
+            data["implementations"].push_back({{"name", implementation->get_property("name")}, {"domain", implementation->get_property("domain")}, {"version", implementation->get_property("version")}});
+        }
+    }
+
+    for (const auto &[a, _] : known_facts_of(model, "abstracts"))
+    {
+        const ComponentModelPtr supermodel(std::static_pointer_cast<ComponentModel>(a.lock()));
+        data["abstracts"].push_back({{"name", supermodel->get_property("name")}, {"domain", supermodel->get_property("domain")}, {"version", supermodel->get_property("version")}});
+    }
+
+    //data["interfaces_of_abstracts"] = nl::json::array();
+    for (const auto &[ti, _] : model.get_facts("interfaces"))
+    {
+        const InterfacePtr this_interface(std::static_pointer_cast<Interface>(ti.lock()));
+        for (const auto &[ai, _] : known_facts_of(*this_interface, "interfaces_of_abstracts"))
+        {
+            const InterfacePtr abstract_interface(std::static_pointer_cast<Interface>(ai.lock()));
+            const ComponentModelPtr abstract(std::static_pointer_cast<ComponentModel>(abstract_interface->get_facts("parent").at(0).target.lock()));
+            nl::json ioa;
+            ioa["abstract_model_name"] = abstract->get_name(); 
+            ioa["abstract_interface_direction"] = abstract_interface->get_direction();
+            ioa["abstract_interface_name"] = abstract_interface->get_name(); 
+            ioa["abstract_interface_type"] = abstract_interface->get_type()->get_property("name");
+            data["interfaces_of_abstracts"].push_back(ioa);
+        }
+    
+    }
+    if(model.has_facts("configured_for"))
+    {
+    for (const auto &[h, _] : model.get_facts("configured_for"))
+    {
+        const xtypes::ComponentModelPtr hardware_model(std::static_pointer_cast<ComponentModel>(h.lock()));
+
+        data["configured_for"]
+            .push_back({{"name", hardware_model->get_property("name")},{"version", hardware_model->get_property("version")}, {"uri", hardware_model->uri()}});
+    }
+    }
+    return data;
+}
+
+// Returns the entries of the version of a model in the DROCK BasicModel Json format (without the components and (dynamic) interfaces)
+static nl::json basic_model_version_header_of(ComponentModel& model)
+{
+    nl::json version;
+    version["name"] = model.get_version();
+    version["date"] = model.get_date();
+    version["designedBy"] = model.get_designedBy();
+    version["projectName"] = model.get_projectName();
+    version["maturity"] = model.get_maturity();
+    version["can_have_parts"] = model.get_can_have_parts();
+    version["abstract"] = model.get_abstract();
+    if (const nl::json defaultConfiguration = model.get_defaultConfiguration(); !defaultConfiguration.empty())
+    {
+        version["defaultConfiguration"] = defaultConfiguration;
+    }
+
+    if (model.has_facts("external_references")) {
+        for (const auto &[p, e] : model.get_facts("external_references"))
+        {
+            const xtypes::ExternalReferencePtr reference(std::static_pointer_cast<ExternalReference>(p.lock()));
+            nl::json referenceData = reference->get_properties();
+            referenceData["optional"] = e.contains("optional") ? e["optional"].get<bool>() : true;
+            version["external_references"].push_back(referenceData);
+        }
+    }
+
+    if (const nl::json self_data = model.get_data(); !self_data.empty()) 
+    {
+        version["data"] = self_data;
+    }
+    return version;
+}
+
+// Receives the entries of a list of the DROCK BasicModel Json format one by one
+using BasicModelEntryFunc = std::function< void(nl::json&&) >;
+
+// Walks the parts of a model and hands their entries to the given functions (which are optional).
+// The entries are handed over in the order in which they appear in their lists (components/nodes, components/configuration/nodes, components/edges and components/configuration/edges).
+static void walk_basic_model_components(ComponentModel& model, const BasicModelEntryFunc& on_node, const BasicModelEntryFunc& on_node_configuration, const BasicModelEntryFunc& on_edge, const BasicModelEntryFunc& on_edge_configuration)
+{
+    const bool with_edges(on_edge || on_edge_configuration);
+    for (const auto &[p, _] : model.get_facts("parts"))
+    {
+        const xtypes::ComponentPtr part(std::static_pointer_cast<Component>(p.lock()));
+        nl::json partData;
+        if (on_node)
+        {
+            partData["name"] = part->get_name();
+            partData["alias"] = part->get_alias();
+            partData["model"] = nl::json();
+            const xtypes::ComponentModelPtr target(part->get_type());
+            partData["model"]["name"] = target->get_name();
+            partData["model"]["domain"] = target->get_domain();
+            partData["model"]["version"] = target->get_version(); // NOTE: added \" to satisfy assertion(type == type) in xtype when importing
+        }
+        if (on_node_configuration && part->has_property("configuration") && !part->get_property("configuration").empty())
+        {
+            nl::json config;
+            if (part->get_property("configuration").is_string() && !part->get_property("configuration").get<std::string>().empty())
+                config = xtypes::parseJson(part->get_property("configuration").get<std::string>(), "xtypes::ComponentModel::exportToBasicModelJSON()->configuration");
+            else
+                config = part->get_property("configuration");
+            if (config.contains("name"))
+            {
+                config["name"] = part->get_name();
+                on_node_configuration(std::move(config));
+            }
+        }
+        if (!on_node && !with_edges)
+            continue;
+        partData["interface_aliases"] = nl::json();
+        for (auto &[i, _] : part->get_facts("interfaces"))
+        {
+            InterfacePtr interface = std::static_pointer_cast<Interface>(i.lock());
+            // Store the part interface alias
+            partData["interface_aliases"][interface->get_name()] = interface->get_alias();
+            if (!with_edges)
+                continue;
+            nl::json edgeData;
+            edgeData["from"]["name"] = part->get_name();
+            edgeData["from"]["interface"] = interface->get_name();
+            edgeData["from"]["domain"] = interface->get_domain();
+            for (auto &[otherInterface, otherInterfaceProps] : interface->get_facts("others"))
+            {
+                const std::vector<xtypes::Fact> &parent_component = otherInterface.lock()->get_facts("parent");
+                const xtypes::ComponentPtr otherPart = std::static_pointer_cast<Component>(parent_component[0].target.lock());
+                edgeData["to"]["name"] = otherPart->get_name();
+                edgeData["to"]["interface"] = std::static_pointer_cast<Interface>(otherInterface.lock())->get_name();
+                edgeData["to"]["domain"] = std::static_pointer_cast<Interface>(otherInterface.lock())->get_domain();
+
+                // Handle edge properties
+                const std::vector<std::string> excludes = {"configuration"};
+                for (auto &[prop, val] : otherInterfaceProps.items())
+                {
+                    std::vector<std::string>::const_iterator it = std::find_if(excludes.begin(), excludes.end(), [&prop = prop](const std::string &excluded)
+                                                                               { return excluded == prop; });
+                    if (it != excludes.end())
+                        continue;
+                    edgeData[prop] = val;
+                }
+
+                // Handle edge configuration
+                if (on_edge_configuration && otherInterfaceProps.contains("configuration") && !otherInterfaceProps["configuration"].empty())
+                {
+                    nl::json config;
+                    if (otherInterfaceProps["configuration"].is_string() && !otherInterfaceProps["configuration"].get<std::string>().empty())
+                        config = xtypes::parseJson(otherInterfaceProps["configuration"].get<std::string>(), "xtypes::ComponentModel::exportToBasicModelJSON()->configuration2");
+                    else
+                        config = otherInterfaceProps["configuration"];
+                    if (otherInterfaceProps.contains("name"))
+                    {
+                        config["name"] = otherInterfaceProps["name"];
+                    }
+                    on_edge_configuration(std::move(config));
+                }
+                // NOTE: The edge data is reused for the next connection of the interface, so we hand over a copy
+                if (on_edge)
+                    on_edge(nl::json(edgeData));
+            }
+        }
+        if (on_node)
+            on_node(std::move(partData));
+    }
+}
+
+// Walks the (dynamic) interfaces of a model and hands their entries to the given functions (which are optional)
+static void walk_basic_model_interfaces(ComponentModel& model, const BasicModelEntryFunc& on_interface, const BasicModelEntryFunc& on_dynamic_interface)
+{
+    for (const auto &[i, _] : model.get_facts("interfaces"))
+    {
+        if (!on_interface)
+            break;
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        nl::json props = interface->get_properties();
+        // Special case: domain and type
+        props["domain"] = interface->get_domain();
+        props["type"] = interface->get_type()->get_property("name");
+        const std::vector<xtypes::Fact> original(interface->has_relation("original") ? known_facts_of(*interface, "original") : std::vector<xtypes::Fact>());
+        if (original.size() > 0)
+        {
+            props["linkToNode"] = std::static_pointer_cast<ComponentModel>(original[0].target.lock()->get_facts("parent")[0].target.lock())->get_name();
+            props["linkToInterface"] = std::static_pointer_cast<ComponentModel>(original[0].target.lock())->get_name();
+        }
+        on_interface(std::move(props));
+    }
+
+    for (const auto &[i, _] : model.get_facts("dynamic_interfaces"))
+    {
+        if (!on_dynamic_interface)
+            break;
+        const DynamicInterfacePtr interface(std::static_pointer_cast<DynamicInterface>(i.lock()));
+        nl::json props = interface->get_properties();
+        // Special case: domain and type
+        props["domain"] = interface->get_domain();
+        props["type"] = interface->get_type()->get_property("name");
+        /// original is a featured we might add later for dynamic interfaces as well
+        on_dynamic_interface(std::move(props));
+    }
+}
+
+// This method exports a component model to the DROCK BasicModel Json format
+std::string xtypes::ComponentModel::export_to_basic_model()
+{
+    return export_to_basic_model_json().dump();
+}
+
+nl::json xtypes::ComponentModel::export_to_basic_model_json()
+{
+    nl::json data(basic_model_header_of(*this));
+    nl::json version(basic_model_version_header_of(*this));
+    auto push_to = [](nl::json& list) -> BasicModelEntryFunc {
+        return [&list](nl::json&& entry) { list.push_back(std::move(entry)); };
+    };
+    walk_basic_model_components(*this, push_to(version["components"]["nodes"]), push_to(version["components"]["configuration"]["nodes"]),
+                                push_to(version["components"]["edges"]), push_to(version["components"]["configuration"]["edges"]));
+    walk_basic_model_interfaces(*this, push_to(version["interfaces"]), push_to(version["dynamic_interfaces"]));
+    // NOTE: Lists without entries are left out
+    for (const std::string list : {"interfaces", "dynamic_interfaces"})
+        if (version[list].is_null())
+            version.erase(list);
+    for (const std::string list : {"nodes", "edges"})
+        if (version["components"]["configuration"][list].is_null())
+            version["components"]["configuration"].erase(list);
+    if (version["components"]["configuration"].empty())
+        version["components"].erase("configuration");
+    for (const std::string list : {"nodes", "edges"})
+        if (version["components"][list].is_null())
+            version["components"].erase(list);
+    if (version["components"].empty())
+        version.erase("components");
+
+    data["versions"].push_back(version);
+    return data;
+}
+
+// Writes a JSON document piece by piece into a write function
+// Containers can be opened lazily. Those appear in the output only if they get any entries (like the lists of nl::json which are created by their first push_back()).
+class BasicModelJsonWriter
+{
+    public:
+        BasicModelJsonWriter(const BasicModelWriteFunc& write) : m_write(write) {}
+
+        // Opens an object or array (the key is ignored inside of arrays and for the document itself)
+        void open(const std::string& key, const bool is_array, const bool lazy = false)
+        {
+            m_stack.push_back({key, is_array, false, true});
+            if (!lazy)
+                this->materialize();
+        }
+
+        void close()
+        {
+            if (m_stack.back().written)
+                m_buffer += m_stack.back().is_array ? ']' : '}';
+            m_stack.pop_back();
+            if (m_stack.empty())
+                this->flush();
+        }
+
+        // Writes an entry of the current object
+        void value(const std::string& key, const nl::json& val)
+        {
+            this->materialize();
+            this->separate(m_stack.back(), key);
+            m_buffer += val.dump();
+            if (m_buffer.size() >= buffer_size)
+                this->flush();
+        }
+
+        // Writes an entry of the current array
+        void value(const nl::json& val)
+        {
+            this->value(std::string(), val);
+        }
+
+        void flush()
+        {
+            if (m_buffer.empty())
+                return;
+            m_write(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+        }
+
+    private:
+        static constexpr std::size_t buffer_size = 1 << 16;
+        struct Frame
+        {
+            std::string key;
+            bool is_array;
+            bool written;
+            bool empty;
+        };
+        const BasicModelWriteFunc& m_write;
+        std::vector< Frame > m_stack;
+        std::string m_buffer;
+
+        // Writes the separator and the key (inside of objects) of the next entry of a container
+        void separate(Frame& container, const std::string& key)
+        {
+            if (!container.empty)
+                m_buffer += ',';
+            container.empty = false;
+            if (!container.is_array)
+                m_buffer += nl::json(key).dump() + ':';
+        }
+
+        // Writes the openings of all lazily opened containers
+        void materialize()
+        {
+            for (std::size_t index = 0; index < m_stack.size(); ++index)
+            {
+                Frame& frame(m_stack[index]);
+                if (frame.written)
+                    continue;
+                if (index > 0)
+                    this->separate(m_stack[index - 1], frame.key);
+                m_buffer += frame.is_array ? '[' : '{';
+                frame.written = true;
+            }
+        }
+};
+
+void xtypes::export_to_basic_model(const ComponentModelPtr& model, const BasicModelWriteFunc& write)
+{
+    BasicModelJsonWriter writer(write);
+    const nl::json data(basic_model_header_of(*model));
+    const nl::json version(basic_model_version_header_of(*model));
+    auto write_to = [&writer]() -> BasicModelEntryFunc {
+        return [&writer](nl::json&& entry) { writer.value(entry); };
+    };
+    // NOTE: To match ComponentModel::export_to_basic_model(), the entries of the objects are written ordered by their keys
+    // The 'versions' are the last toplvl entry
+    writer.open("", false);
+    for (const auto& [key, val] : data.items())
+        writer.value(key, val);
+    writer.open("versions", true);
+    writer.open("", false);
+    std::map< std::string, std::function< void() > > entries;
+    for (const auto& [key, val] : version.items())
+        entries[key] = [&writer, &key = key, &val = val]() { writer.value(key, val); };
+    entries["components"] = [&]() {
+        writer.open("components", false, true);
+        writer.open("configuration", false, true);
+        writer.open("edges", true, true);
+        walk_basic_model_components(*model, nullptr, nullptr, nullptr, write_to());
+        writer.close();
+        writer.open("nodes", true, true);
+        walk_basic_model_components(*model, nullptr, write_to(), nullptr, nullptr);
+        writer.close();
+        writer.close();
+        writer.open("edges", true, true);
+        walk_basic_model_components(*model, nullptr, nullptr, write_to(), nullptr);
+        writer.close();
+        writer.open("nodes", true, true);
+        walk_basic_model_components(*model, write_to(), nullptr, nullptr, nullptr);
+        writer.close();
+        writer.close();
+    };
+    entries["dynamic_interfaces"] = [&]() {
+        writer.open("dynamic_interfaces", true, true);
+        walk_basic_model_interfaces(*model, nullptr, write_to());
+        writer.close();
+    };
+    entries["interfaces"] = [&]() {
+        writer.open("interfaces", true, true);
+        walk_basic_model_interfaces(*model, write_to(), nullptr);
+        writer.close();
+    };
+    for (const auto& [_, write_entry] : entries)
+        write_entry();
+    writer.close();
+    writer.close();
+    writer.close();
+}
+
+void xtypes::export_to_basic_model(const ComponentModelPtr& model, std::ostream& out)
+{
+    export_to_basic_model(model, [&out](const char* data, const std::size_t size) {
+        out.write(data, size);
+    });
+    if (!out)
+    {
+        throw std::runtime_error("xtypes::export_to_basic_model(): Could not write " + model->get_name());
+    }
+}
+
+void xtypes::ComponentModel::export_to_basic_model_file(const std::string &path)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        throw std::invalid_argument("ComponentModel::export_to_basic_model_file(): Could not open " + path);
+    }
+    xtypes::export_to_basic_model(std::static_pointer_cast<ComponentModel>(shared_from_this()), out);
+}
+
+std::vector<std::string> xtypes::ComponentModel::export_many(const std::vector<ComponentModelPtr> &models, const int &max_threads)
+{
+    // NOTE: The export only reads the models, so they can be exported concurrently (even if they share parts or supermodels)
+    std::vector<std::string> result(models.size());
+    for_each_in_parallel(models.size(), max_threads, [&](const std::size_t index) {
+        result[index] = models[index]->export_to_basic_model();
+    });
+    return result;
+}
+
+std::vector<std::uint8_t> xtypes::export_to_basic_model(const ComponentModelPtr& model, const BasicModelEncoding encoding)
+{
+    const nl::json data(model->export_to_basic_model_json());
+    switch (encoding)
+    {
+        case BasicModelEncoding::CBOR:
+            return nl::json::to_cbor(data);
+        case BasicModelEncoding::MSGPACK:
+            return nl::json::to_msgpack(data);
+        default:
+            break;
+    }
+    const std::string serialized_model(data.dump());
+    return std::vector<std::uint8_t>(serialized_model.begin(), serialized_model.end());
+}
+
+// The state of an import from the DROCK BasicModel Json format which is shared by all versions
+struct BasicModelImport
+{
+    XTypeRegistryPtr registry;
+    // The toplvl properties (without the versions)
+    nl::json data;
+    std::string name;
+    std::string domain;
+    std::vector<ComponentModelPtr> supermodels;
+    std::vector<ComponentModelPtr> configured_for;
+    std::map<std::string, ComponentModelPtr> part_models;
+    // The interface models by (type, domain). This includes the ones which have been created because they could not be loaded.
+    std::map<std::pair<std::string, std::string>, InterfaceModelPtr> interface_models;
+    // The result of the batch load of the referenced models (nullptr if a model could not be loaded)
+    std::map<std::string, XTypePtr> prefetched;
+};
+
+// The batch load hooks by registry
+static std::mutex batch_load_funcs_mutex;
+static std::map< const XTypeRegistry*, std::pair< std::weak_ptr< XTypeRegistry >, BatchLoadFunc > > batch_load_funcs;
+
+void xtypes::set_batch_load_func(const XTypeRegistryPtr& registry, const BatchLoadFunc& func)
+{
+    std::lock_guard< std::mutex > lock(batch_load_funcs_mutex);
+    // Forget the hooks of registries which are gone
+    for (auto it = batch_load_funcs.begin(); it != batch_load_funcs.end();)
+        it = it->second.first.expired() ? batch_load_funcs.erase(it) : std::next(it);
+    if (func)
+        batch_load_funcs[registry.get()] = {registry, func};
+    else
+        batch_load_funcs.erase(registry.get());
+}
+
+BatchLoadFunc xtypes::get_batch_load_func(const XTypeRegistryPtr& registry)
+{
+    std::lock_guard< std::mutex > lock(batch_load_funcs_mutex);
+    const auto& it(batch_load_funcs.find(registry.get()));
+    // NOTE: The address of a registry which is gone could have been reused
+    if ((it == batch_load_funcs.end()) || (it->second.first.lock() != registry))
+        return nullptr;
+    return it->second.second;
+}
+
+// Loads the given URIs with the batch load hook of the registry (if any) and remembers the result for the rest of the import
+static void prefetch_basic_model_references(BasicModelImport& ctx, const std::vector<std::string>& uris)
+{
+    const BatchLoadFunc batch_load(get_batch_load_func(ctx.registry));
+    if (!batch_load)
+        return;
+    // Only the URIs which are not known to the registry yet have to be loaded
+    std::vector<std::string> to_load;
+    for (const auto& uri : uris)
+    {
+        if (ctx.prefetched.count(uri) || ctx.registry->get_by_uri(uri))
+            continue;
+        ctx.prefetched[uri] = nullptr;
+        to_load.push_back(uri);
+    }
+    if (to_load.empty())
+        return;
+    for (auto& [uri, xtype] : batch_load(to_load))
+        ctx.prefetched[uri] = std::move(xtype);
+}
+
+// Loads a referenced model. The ones which have been prefetched (or failed to) do not reach the registry backend again.
+static XTypePtr load_basic_model_reference(BasicModelImport& ctx, const std::string& uri)
+{
+    const auto& it(ctx.prefetched.find(uri));
+    if (it != ctx.prefetched.end())
+        return it->second;
+    return ctx.registry->load_by_uri(uri);
+}
+
+// The parts of a version which have been imported so far. They are indexed by name to keep the import linear in the number of parts.
+struct BasicModelParts
+{
+    struct IndexedPart
+    {
+        ComponentPtr part;
+        // NOTE: Like get_interface(), the first interface with a given name wins
+        std::unordered_map<std::string, InterfacePtr> interfaces;
+    };
+    std::vector<IndexedPart> parts;
+    // NOTE: Part names should be unique, but we keep all parts with the same name in order of creation
+    std::unordered_map<std::string, std::vector<std::size_t>> by_name;
+    // The connections created by the import (indexed by connection name)
+    struct Connection
+    {
+        InterfacePtr from;
+        InterfacePtr to;
+        nl::json properties;
+        bool configured = false;
+    };
+    std::unordered_map<std::string, std::vector<Connection>> connections;
+
+    void add(const ComponentPtr& part)
+    {
+        IndexedPart indexed{part, {}};
+        for (const auto &[i, _] : part->get_facts("interfaces"))
+        {
+            InterfacePtr interface = std::static_pointer_cast<Interface>(i.lock());
+            indexed.interfaces.emplace(interface->get_name(), std::move(interface));
+        }
+        by_name[part->get_name()].push_back(parts.size());
+        parts.push_back(std::move(indexed));
+    }
+
+    // Returns the parts with the given name
+    const std::vector<std::size_t>& find(const std::string& name) const
+    {
+        static const std::vector<std::size_t> none;
+        const auto& it(by_name.find(name));
+        return (it == by_name.end()) ? none : it->second;
+    }
+
+    // Returns the interface of a part with the given name (or nullptr)
+    InterfacePtr interface_of(const std::size_t index, const std::string& name) const
+    {
+        const auto& it(parts[index].interfaces.find(name));
+        return (it == parts[index].interfaces.end()) ? nullptr : it->second;
+    }
+};
+
+// Returns the URIs of the models referenced by a serialized model (supermodels, configured_for hardware, interface models and the given part models)
+static std::vector<std::string> collect_basic_model_references(const nl::json& data, const std::vector<nl::json>& part_models)
+{
+    std::vector<std::string> uris;
+    if (!data.contains("domain") || !data["domain"].is_string())
+        return uris;
+    const std::string domain(data["domain"].get<std::string>());
+    if (data.contains("types"))
+    {
+        for (const auto& t : data["types"])
+        {
+            ComponentModel dummy;
+            dummy.set_properties({{"name", t["name"]}, {"version", t["version"]}, {"domain", domain}});
+            uris.push_back(dummy.uri());
+        }
+    }
+    if (data.contains("configured_for"))
+    {
+        for (const auto& h : data["configured_for"])
+            uris.push_back(h["uri"].get<std::string>());
+    }
+    for (const auto& model : part_models)
+    {
+        if (!model.contains("name") || !model.contains("domain") || !model.contains("version"))
+            continue;
+        ComponentModel dummy;
+        dummy.set_properties(model);
+        uris.push_back(dummy.uri());
+    }
+    if (data.contains("versions"))
+    {
+        for (const auto& v : data["versions"])
+        {
+            for (const std::string kind : {"interfaces", "dynamic_interfaces"})
+            {
+                if (!v.contains(kind))
+                    continue;
+                for (const auto& modelIf : v[kind])
+                {
+                    // NOTE: The default domain is the one of the owning model (see import_basic_model_interfaces())
+                    InterfaceModel dummy;
+                    dummy.set_properties({{"name", modelIf.contains("type") ? modelIf["type"].get<std::string>() : std::string("UNKNOWN")},
+                                          {"domain", modelIf.contains("domain") ? modelIf["domain"].get<std::string>() : domain}});
+                    uris.push_back(dummy.uri());
+                }
+            }
+        }
+    }
+    return uris;
+}
+
+// Resolves the toplvl entries which are shared by all versions
+static void begin_basic_model_import(BasicModelImport& ctx, const nl::json& data)
+{
+    ctx.data = data;
+    ctx.data.erase("versions");
+    if (!data.contains("name"))
+    {
+        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'name' in " + ctx.data.dump());
+    }
+    ctx.name = data["name"].get<std::string>();
+    if (!data.contains("domain"))
+    {
+        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'domain' in " + ctx.data.dump());
+    }
+    ctx.domain = data["domain"].get<std::string>();
+
+    // Resolve supermodels
+    if (data.contains("types"))
+    {
+        for (const auto& t : data["types"])
+        {
+            nl::json props = nl::json{{"name", t["name"]}, {"version", t["version"]}, {"domain", ctx.domain}};
+            ComponentModel dummy;
+            dummy.set_properties(props);
+            ComponentModelPtr supermodel = std::static_pointer_cast<ComponentModel>(load_basic_model_reference(ctx, dummy.uri()));
+            if (!supermodel)
+            {
+                supermodel = ctx.registry->instantiate<ComponentModel>();
+                supermodel->set_properties(props);
+            }
+            ctx.supermodels.push_back(supermodel);
+        }
+    }
+
+    // Resolve configured_for
+    if (data.contains("configured_for"))
+    {
+        for (const auto &h : data["configured_for"])
+        {
+            nl::json props = nl::json{{"name", h["name"]}, {"version", h["version"]}, {"uri", h["uri"]}};
+            ComponentModelPtr hardware = std::static_pointer_cast<ComponentModel>(load_basic_model_reference(ctx, h["uri"].get<std::string>()));
+            if (!hardware)
+            {
+                hardware = ctx.registry->instantiate<ComponentModel>();
+                hardware->set_properties(props);
+            }
+            ctx.configured_for.push_back(hardware);
+        }
+    }
+}
+
+// Creates the model of a version (without its parts, connections and interfaces). Returns nullptr if the version is invalid.
+// NOTE: The components of the version are not needed here
+static ComponentModelPtr create_basic_model_version(BasicModelImport& ctx, const nl::json& v)
+{
+    if (!v.contains("name"))
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find 'name' in versions " << v.dump() << ". Ignoring it.\n";
+        return nullptr;
+    }
+    const std::string version(v["name"].get<std::string>());
+
+    // Setup the properties
+    nl::json props;
+    // At first, set second lvl properties
+    props = v;
+    // Then override by toplvl properties
+    props.update(ctx.data);
+    // ... and set version (since this collides with toplvl name)
+    props["version"] = version;
+
+    // Create new model with specific version
+    ComponentModelPtr model = ctx.registry->instantiate<ComponentModel>();
+    model->set_all_unknown_facts_empty();
+    model->set_properties(props, false);
+    // Attach supermodels
+    for (auto& supermodel : ctx.supermodels)
+    {
+        // .. to subclass_of relation
+        model->subclass_of(supermodel);
+    }
+
+    // Attach configured_for
+    for (auto &hardware : ctx.configured_for)
+    {
+        // .. to configured_for relation
+        model->add_configured_for(hardware);
+    }
+
+    // Handle defaultConfigurations
+    if (v.contains("defaultConfiguration"))
+        model->set_defaultConfiguration(v["defaultConfiguration"]);
+
+    // Resolve/create external references
+    if (v.contains("external_references")) {
+        assert(v["external_references"].is_array());
+        for (const auto &eRefIt : v["external_references"])
+        {
+            // TODO: Actually, the ExternalReference has to be looked up FIRST (by load_missing_external_reference or such) and only created if not found
+            AutoprojReferencePtr eRef = ctx.registry->instantiate<AutoprojReference>();
+            eRef->set_properties(eRefIt);
+            // Afterwards we annotate the model with the external reference
+            model->annotate_with((AutoprojReferencePtr)eRef, eRefIt["optional"]);
+        }
+    }
+
+    // Handle deprecated repository
+    if (v.contains("repository"))
+        throw std::runtime_error("The 'repository' property of ComponentModel is deprecated. Please use the ExternalReference relation instead.");
+    // Handle assemblyData
+    const std::string& domain(ctx.domain);
+    if (domain == "ASSEMBLY" && v.contains("assemblyData"))
+        model->set_data(v["assemblyData"]);
+    else if (domain == "SOFTWARE" && v.contains("softwareData"))
+        model->set_data(v["softwareData"]);
+    else if (domain == "ELECTRONICS" && v.contains("electronicsData"))
+        model->set_data(v["electronicsData"]);
+    else if (domain == "MECHANICS" && v.contains("mechanicsData"))
+        model->set_data(v["mechanicsData"]);
+    else if (domain == "COMPUTATION" && v.contains("computationData"))
+        model->set_data(v["computationData"]);
+    else if (v.contains("data"))
+        model->set_data(v["data"]);
+    return model;
+}
+
+// Returns the model of a part (components/nodes entry). It is loaded only once per import (nullptr if it could not be loaded).
+static ComponentModelPtr resolve_basic_model_part_model(BasicModelImport& ctx, const nl::json& part)
+{
+    const std::string partModelName(part["model"]["name"].get<std::string>());
+    const std::string partModelDomain(part["model"]["domain"].get<std::string>());
+    const std::string partModelVersion(part["model"]["version"].get<std::string>());
+
+    // First lookup component model in cache
+    const std::string lookup(partModelName + partModelDomain + partModelVersion);
+    const auto& it(ctx.part_models.find(lookup));
+    if (it != ctx.part_models.end())
+        return it->second;
+    // ... if not found, call provided function to search for a matching part model
+    ComponentModel dummy;
+    dummy.set_properties(part["model"]);
+    ComponentModelPtr partModel = std::static_pointer_cast<ComponentModel>(load_basic_model_reference(ctx, dummy.uri()));
+    // and place it into cache
+    // NOTE: Models which could not be loaded are cached as well, so the registry is asked only once for them
+    ctx.part_models[lookup] = partModel;
+    return partModel;
+}
+
+// The links of imported parts and their interfaces to their (shared) models.
+// When versions are imported in parallel, these are collected per version and established afterwards in a deterministic order.
+// The parts and interfaces themselves are instantiated up front (in the order of a serial import), so they become known to the registry in a deterministic order as well.
+struct BasicModelLinks
+{
+    std::vector<std::pair<ComponentPtr, ComponentModelPtr>> parts;
+    std::vector<std::pair<InterfacePtr, InterfaceModelPtr>> interfaces;
+    // The instantiated parts and interfaces which have not been used yet (in order of use)
+    std::deque<ComponentPtr> instantiated_parts;
+    std::deque<InterfacePtr> instantiated_interfaces;
+
+    // Instantiates a part of the given model and its interfaces for later use
+    void instantiate(const XTypeRegistryPtr& registry, const ComponentModelPtr& part_model)
+    {
+        instantiated_parts.push_back(registry->instantiate<Component>());
+        for (std::size_t index = 0; index < part_model->get_facts("interfaces").size(); ++index)
+            instantiated_interfaces.push_back(registry->instantiate<Interface>());
+    }
+
+    template < class T >
+    static std::shared_ptr<T> take(std::deque< std::shared_ptr<T> >& instantiated)
+    {
+        if (instantiated.empty())
+            throw std::logic_error("BasicModelLinks: No instantiated " + T::classname + " left");
+        std::shared_ptr<T> next(std::move(instantiated.front()));
+        instantiated.pop_front();
+        return next;
+    }
+
+    void apply() const
+    {
+        for (const auto& [part, model] : parts)
+            part->instance_of(model);
+        for (const auto& [interface, model] : interfaces)
+            interface->instance_of(model);
+    }
+};
+
+// Like ComponentModel::instantiate(), but it can be called concurrently for different wholes:
+// The part and its interfaces have been instantiated before and the links to the models are only collected
+static ComponentPtr instantiate_basic_model_part(const ComponentModelPtr& part_model, const ComponentModelPtr& whole, const std::string& name, BasicModelLinks& links)
+{
+    ComponentPtr comp = BasicModelLinks::take(links.instantiated_parts);
+    comp->set_all_unknown_facts_empty();
+    comp->set_properties(part_model->get_properties(), false);
+    if (!name.empty())
+        comp->set_name(name);
+    comp->set_configuration(part_model->get_defaultConfiguration());
+    whole->composed_of(comp);
+    links.parts.push_back({comp, part_model});
+    for (const auto &[i, _] : part_model->get_facts("interfaces"))
+    {
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        InterfacePtr clone = BasicModelLinks::take(links.instantiated_interfaces);
+        clone->set_properties(interface->get_properties());
+        clone->set_all_unknown_facts_empty();
+        comp->has(clone);
+        links.interfaces.push_back({clone, interface->get_type()});
+    }
+    return comp;
+}
+
+// Creates a part (components/nodes entry) of a model. Returns false if the import of this version has to be stopped.
+// Non-fatal errors are reported through error_occurred. If links are given, the part is not linked to its model yet (see BasicModelLinks).
+static bool import_basic_model_part(BasicModelImport& ctx, const ComponentModelPtr& model, const nl::json& part, BasicModelParts& parts, bool& error_occurred, BasicModelLinks* links = nullptr)
+{
+    const std::string partName(part["name"].get<std::string>());
+    const std::string partModelName(part["model"]["name"].get<std::string>());
+    ComponentModelPtr partModel(resolve_basic_model_part_model(ctx, part));
+    // If the model has not been found, ignore it
+    if (!partModel)
+    {
+        std::cerr << "ComponentModel::import_from_basic_model: Could not load model " + partModelName + " for part " + partName << "\n";
+        return false;
+    }
+
+    // Create the part (and set all inner facts to be empty, not unknown)
+    ComponentPtr p = links ? instantiate_basic_model_part(partModel, model, partName, *links) : partModel->instantiate(model, partName, true);
+    if (!p)
+    {
+        std::cerr << "ComponentModel::import_from_basic_model: Could instantiate part " + partName << "\n";
+        return false;
+    }
+    // Set alias (if given)
+    if (part.contains("alias"))
+    {
+        p->set_alias(part["alias"]);
+    }
+    // Set interface aliases
+    if (part.contains("interface_aliases"))
+    {
+        for (const auto&[ifName, ifAlias] : part["interface_aliases"].items())
+        {
+            xtypes::InterfacePtr pi = p->get_interface(ifName);
+            if (!pi)
+            {
+                std::cerr << "ComponentModel::import_from_basic_model: Could not find part interface " + ifName + " to set alias\n";
+                error_occurred = true;
+                continue;
+            }
+            pi->set_alias(ifAlias);
+        }
+    }
+    parts.add(p);
+    return true;
+}
+
+// Connects two part interfaces (components/edges entry) of a model. Returns false on error.
+static bool import_basic_model_edge(const nl::json& conn, BasicModelParts& parts)
+{
+    // Check and parse info for source part
+    if (!conn.contains("from"))
+    {
+        std::cerr << "XType::import_from_basic_model: 'from' entry missing in " << conn.dump() << "\n";
+        return false;
+    }
+    if (!conn["from"].contains("name"))
+    {
+        std::cerr << "XType::import_from_basic_model: 'name' entry missing in " << conn["from"].dump() << "\n";
+        return false;
+    }
+    const std::string fromPartName(conn["from"]["name"].get<std::string>());
+    if (!conn["from"].contains("interface"))
+    {
+        std::cerr << "XType::import_from_basic_model: interface entry in 'from' for part " << fromPartName << " is missing.\n";
+        return false;
+    }
+    const std::string fromPartInterfaceName(conn["from"]["interface"].get<std::string>());
+    std::string fromPartInterfaceDomain(std::string("NOT_SET"));
+    if (conn["from"].contains("domain"))
+    {
+        fromPartInterfaceDomain = conn["from"]["domain"].get<std::string>();
+    }
+
+    // Check and parse info for destination part
+    if (!conn.contains("to"))
+    {
+        std::cerr << "XType::import_from_basic_model: 'to' entry missing in " << conn.dump() << "\n";
+        return false;
+    }
+    if (!conn["to"].contains("name"))
+    {
+        std::cerr << "XType::import_from_basic_model: 'name' entry missing in " << conn["to"].dump() << "\n";
+        return false;
+    }
+    const std::string toPartName(conn["to"]["name"].get<std::string>());
+    if (!conn["to"].contains("interface"))
+    {
+        std::cerr << "XType::import_from_basic_model: interface entry in 'to' for part " << toPartName << " is missing.\n";
+        return false;
+    }
+    const std::string toPartInterfaceName(conn["to"]["interface"].get<std::string>());
+    std::string toPartInterfaceDomain(std::string("NOT_SET"));
+    if (conn["to"].contains("domain"))
+    {
+        toPartInterfaceDomain = conn["to"]["domain"].get<std::string>();
+    }
+
+    // Resolve source part, source interface, destination part and destination interface to connect them
+    // Find source and destination parts first ...
+    const std::vector<std::size_t>& fromParts(parts.find(fromPartName));
+    if (fromParts.empty())
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find source part " + fromPartName << "\n";
+        return false;
+    }
+    const std::vector<std::size_t>& toParts(parts.find(toPartName));
+    if (toParts.empty())
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find target part " + toPartName << "\n";
+        return false;
+    }
+    // ... then the interfaces
+    // TODO: Should we check the interface domains?
+    const InterfacePtr fromInterface(parts.interface_of(fromParts.front(), fromPartInterfaceName));
+    if (!fromInterface)
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find source interface " + fromPartInterfaceName + " at part " + fromPartName << "\n";
+        return false;
+    }
+    const InterfacePtr toInterface(parts.interface_of(toParts.front(), toPartInterfaceName));
+    if (!toInterface)
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find target interface " + toPartInterfaceName + " at part " + toPartName << "\n";
+        return false;
+    }
+    // Connect src and target interface
+    // Now that we have a global registry, a connection could already be existent!
+    // NOTE: An existing connection keeps its properties (and name), so only new connections are indexed
+    const bool existent = fromInterface->is_connected_to(toInterface);
+    if (!fromInterface->connected_to(toInterface, conn))
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not connect " + fromPartInterfaceName + " and " + toPartInterfaceName << "\n";
+        return false;
+    }
+    if (!existent && conn.contains("name") && conn["name"].is_string())
+        parts.connections[conn["name"].get<std::string>()].push_back({fromInterface, toInterface, conn, false});
+    return true;
+}
+
+// Applies the configuration of a part (components/configuration/nodes entry). Returns false on error.
+static bool import_basic_model_part_configuration(const ComponentModelPtr& model, const nl::json& config, const BasicModelParts& parts)
+{
+    // Sometimes old DROCK stuff produces empty config entries
+    if (!config.contains("name"))
+        return true;
+    const std::string partName(config["name"].get<std::string>());
+    const std::vector<std::size_t>& matches(parts.find(partName));
+    for (const std::size_t index : matches)
+        parts.parts[index].part->set_property("configuration", config);
+    if (matches.empty())
+    {
+        std::cerr << "ComponentModel::import_from_basic_model(): Could not find part " + partName + " in model " + model->get_name() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Applies the configurations of the connections (components/configuration/edges entries) in order until the first error. Returns false on error.
+static bool import_basic_model_edge_configurations(const ComponentModelPtr& model, const std::vector<nl::json>& configs, BasicModelParts& parts)
+{
+    // NOTE: The connections are looked up by name and every configured connection gets its properties updated only once (the last configuration wins)
+    std::vector<BasicModelParts::Connection*> configured;
+    bool ok = true;
+    for (const auto& config : configs)
+    {
+        // Sometimes old DROCK stuff produces empty config entries
+        if (!config.contains("name"))
+            continue;
+        const std::string connectionName(config["name"].get<std::string>());
+        const auto& it(parts.connections.find(connectionName));
+        if (it == parts.connections.end())
+        {
+            std::cerr << "ComponentModel::import_from_basic_model(): Could not find connection " + connectionName + " in model " + model->get_name() << std::endl;
+            ok = false;
+            break;
+        }
+        for (auto& connection : it->second)
+        {
+            if (!connection.configured)
+                configured.push_back(&connection);
+            connection.configured = true;
+            connection.properties["configuration"] = config;
+        }
+    }
+    for (const BasicModelParts::Connection* connection : configured)
+    {
+        // NOTE: We reinsert the same fact to update the edge properties
+        XTypeCPtr src_interface = connection->from;
+        src_interface->add_fact("others", connection->to, connection->properties);
+    }
+    return ok;
+}
 
-                    // Check and parse info for destination part
-                    if (!conn.contains("to"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: 'to' entry missing in " << conn.dump() << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    if (!conn["to"].contains("name"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: 'name' entry missing in " << conn["to"].dump() << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    const std::string toPartName(conn["to"]["name"].get<std::string>());
-                    if (!conn["to"].contains("interface"))
-                    {
-                        std::cerr << "XType::import_from_basic_model: interface entry in 'to' for part " << toPartName << " is missing.\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    const std::string toPartInterfaceName(conn["to"]["interface"].get<std::string>());
-                    std::string toPartInterfaceDomain(std::string("NOT_SET"));
-                    if (conn["to"].contains("domain"))
-                    {
-                        toPartInterfaceDomain = conn["to"]["domain"].get<std::string>();
-                    }
+// Returns the interface model of the given type and domain. It is loaded (or created if that fails) only once per import.
+static InterfaceModelPtr resolve_basic_model_interface_model(BasicModelImport& ctx, const std::string& name, const std::string& domain)
+{
+    // First lookup interface model in cache
+    const std::pair<std::string, std::string> lookup(name, domain);
+    const auto& it(ctx.interface_models.find(lookup));
+    if (it != ctx.interface_models.end())
+        return it->second;
+    // ... if not found, create a dummy and try to load it before creating it new
+    InterfaceModel dummy;
+    dummy.set_properties({{"name", name},
+                             {"domain", domain}});
+    InterfaceModelPtr ifModel = std::static_pointer_cast<InterfaceModel>(load_basic_model_reference(ctx, dummy.uri()));
+    if (!ifModel)
+    {
+        // create a new interface model
+        ifModel = ctx.registry->instantiate<InterfaceModel>();
+        ifModel->set_properties(dummy.get_properties());
+    }
+    // NOTE: Models which could not be loaded are cached as well, so the registry is asked only once for them
+    ctx.interface_models.emplace(lookup, ifModel);
+    return ifModel;
+}
 
-                    // Resolve source part, source interface, destination part and destination interface to connect them
-                    // First resolve source part and interface
-                    ComponentPtr fromPart{nullptr}, toPart{nullptr};
-                    InterfacePtr fromInterface{nullptr}, toInterface{nullptr};
-                    // Find source and destination parts first ...
-                    for (const auto part : parts)
-                    {
-                        if (part->get_name() == fromPartName)
-                            fromPart = part;
-                        if (part->get_name() == toPartName)
-                            toPart = part;
-                        if (fromPart && toPart)
-                            break;
-                    }
-                    if (!fromPart)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not find source part " + fromPartName << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    if (!toPart)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not find target part " + toPartName << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    // ... then the interfaces
-                    for (const auto &[fpi, _] : fromPart->get_facts("interfaces"))
-                    {
-                        // TODO: Should we check the interface domains?
-                        // if fromPartInterfaceDomain != fromPartInterface.domain:
-                        //    continue
-                        InterfacePtr fromPartInterface = std::static_pointer_cast<Interface>(fpi.lock());
-                        if (fromPartInterface->get_name() == fromPartInterfaceName)
-                        {
-                            fromInterface = std::move(fromPartInterface);
-                            break;
-                        }
-                    }
-                    if (!fromInterface)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not find source interface " + fromPartInterfaceName + " at part " + fromPartName << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    for (const auto &[tpi, _] : toPart->get_facts("interfaces"))
-                    {
-                        // TODO: Should we check the interface domains?
-                        // if toPartInterfaceDomain != toPartInterface.domain:
-                        //    continue
-                        InterfacePtr toPartInterface = std::static_pointer_cast<Interface>(tpi.lock());
-                        if (toPartInterface->get_name() == toPartInterfaceName)
-                        {
-                            toInterface = std::move(toPartInterface);
-                            break;
-                        }
-                    }
-                    if (!toInterface)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not find target interface " + toPartInterfaceName + " at part " + toPartName << "\n";
-                        error_occurred = true;
-                        break;
-                    }
-                    // Connect src and target interface
-                    // Now that we have a global registry, a connection could already be existent!
-                    error_occurred = !fromInterface->connected_to(toInterface, conn);
-                    if (error_occurred)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not connect " + fromPartInterfaceName + " and " + toPartInterfaceName << "\n";
-                        break;
-                    }
-                }
+// Creates the (dynamic) interfaces of a model. Returns false on error.
+static bool import_basic_model_interfaces(BasicModelImport& ctx, const ComponentModelPtr& model, const nl::json& v, const BasicModelParts& parts)
+{
+    // Handling interfaces
+    if (v.contains("interfaces"))
+    {
+        for (const auto &modelIf : v["interfaces"])
+        {
+            // First, create the interface model (by type and domain)
+            std::string ifModelName = std::string("UNKNOWN");
+            if (modelIf.contains("type"))
+            {
+                ifModelName = modelIf["type"].get<std::string>();
             }
-
-            // Handle configuration
-            if (v["components"].contains("configuration"))
+            // For the interfaces we set the default domain to the domain of the owning model. That will prevent issues with compatibility checking.
+            std::string ifModelDomain = model->get_domain();
+            if (modelIf.contains("domain"))
+            {
+                ifModelDomain = modelIf["domain"].get<std::string>();
+            }
+            InterfaceModelPtr ifModel = resolve_basic_model_interface_model(ctx, ifModelName, ifModelDomain);
+            // Then we instantiate from it
+            InterfacePtr interface = ifModel->instantiate(model, modelIf["name"].get<std::string>());
+            // ... and update the properties
+            interface->set_properties(modelIf, false);
+
+            // Handle alias interfaces
+            // Set original to empty first
+            interface->set_unknown_fact_empty("original");
+            if (modelIf.contains("linkToNode") && modelIf.contains("linkToInterface"))
             {
-                if (v["components"]["configuration"].contains("nodes"))
+                const std::string partName(modelIf["linkToNode"].get<std::string>());
+                const std::string partInterfaceName(modelIf["linkToInterface"].get<std::string>());
+                // Find part
+                const std::vector<std::size_t>& matches(parts.find(partName));
+                for (const std::size_t index : matches)
                 {
-                    for (const auto &config : v["components"]["configuration"]["nodes"])
+                    // Found part: find interface next
+                    const InterfacePtr partInterface(parts.interface_of(index, partInterfaceName));
+                    if (!partInterface)
                     {
-                        // Sometimes old DROCK stuff produces empty config entries
-                        if (!config.contains("name"))
-                            continue;
-                        const std::string partName(config["name"].get<std::string>());
-                        bool found = false;
-                        for (const auto p : parts)
-                        {
-                            if (p->get_name() != partName)
-                                continue;
-                            found = true;
-                            p->set_property("configuration", config);
-                        }
-                        if (!found)
-                        {
-                            std::cerr << "ComponentModel::import_from_basic_model(): Could not find part " + partName + " in model " + model->get_name() << "\n";
-                            error_occurred = true;
-                            break;
-                        }
+                        std::cerr << "ComponentModel::importFromBasicModelJSON(): Could not find internal interface " + partInterfaceName + " of part " + partName << std::endl;
+                        break;
                     }
+                    // Found matching pair
+                    interface->alias_of(partInterface);
                 }
-                if (v["components"]["configuration"].contains("edges"))
+                if (matches.empty())
                 {
-                    for (const auto &config : v["components"]["configuration"]["edges"])
-                    {
-                        // Sometimes old DROCK stuff produces empty config entries
-                        if (!config.contains("name"))
-                            continue;
-                        std::string connectionName = config["name"].get<std::string>();
-                        bool found = false;
-                        for (const auto &p : parts)
-                        {
-                            for (const auto &[pi, _] : p->get_facts("interfaces"))
-                            {
-                                XTypeCPtr src_interface = pi.lock();
-                                for (const auto &[o, props] : src_interface->get_facts("others"))
-                                {
-                                    if (props["name"].get<std::string>() != connectionName)
-                                        continue;
-                                    found = true;
-                                    // NOTE: We reinsert the same fact to update the edge properties
-                                    XTypeCPtr dst_interface = o.lock();
-                                    nl::json new_props = props;
-                                    new_props["configuration"] = config;
-                                    src_interface->add_fact("others", dst_interface, new_props);
-                                }
-                            }
-                        }
-                        if (!found)
-                        {
-                            std::cerr << "ComponentModel::import_from_basic_model(): Could not find connection " + connectionName + " in model " + model->get_name() << std::endl;
-                            error_occurred = true;
-                            break;
-                        }
-                    }
+                    std::cerr << "ComponentModel::import_from_basic_model(): Could not find part " + partName + " in model " + model->get_name() << std::endl;
+                    return false;
                 }
             }
         }
+    }
 
-        // Handling interfaces
-        if (v.contains("interfaces"))
+    if (v.contains("dynamic_interfaces"))
+    {
+        for (const auto &modelIf : v["dynamic_interfaces"])
         {
-            for (const auto &modelIf : v["interfaces"])
+            // First, create the interface model (by type and domain)
+            std::string ifModelName = std::string("UNKNOWN");
+            if (modelIf.contains("type"))
             {
-                // First, create the interface model (by type and domain)
-                std::string ifModelName = std::string("UNKNOWN");
-                if (modelIf.contains("type"))
-                {
-                    ifModelName = modelIf["type"].get<std::string>();
-                }
-                // For the interfaces we set the default domain to the domain of the owning model. That will prevent issues with compatibility checking.
-                std::string ifModelDomain = model->get_domain();
-                if (modelIf.contains("domain"))
-                {
-                    ifModelDomain = modelIf["domain"].get<std::string>();
-                }
-                // First create a dummy and try to load it before creating it new
-                InterfaceModel dummy;
-                dummy.set_properties({{"name", ifModelName},
-                                         {"domain", ifModelDomain}});
-                InterfaceModelPtr ifModel = std::static_pointer_cast<InterfaceModel>(registry->load_by_uri(dummy.uri()));
-                if (!ifModel)
-                {
-                    // create a new interface model
-                    ifModel = registry->instantiate<InterfaceModel>();
-                    ifModel->set_properties(dummy.get_properties());
-                }
-                // Then we instantiate from it
-                InterfacePtr interface = ifModel->instantiate(model, modelIf["name"].get<std::string>());
-                // ... and update the properties
-                interface->set_properties(modelIf, false);
-
-                // Handle alias interfaces
-                // Set original to empty first
-                interface->set_unknown_fact_empty("original");
-                if (modelIf.contains("linkToNode") && modelIf.contains("linkToInterface"))
-                {
-                    const std::string partName(modelIf["linkToNode"].get<std::string>());
-                    const std::string partInterfaceName(modelIf["linkToInterface"].get<std::string>());
-                    // Find part
-                    bool found = false;
-                    for (const auto part : parts)
-                    {
-                        if (part->get_name() != partName)
-                            continue;
-                        found = true;
-                        // Found part: find interface next
-                        InterfacePtr partInterface{nullptr};
-                        for (const auto &[i, _] : part->get_facts("interfaces"))
-                        {
-                            InterfacePtr pi = std::static_pointer_cast<Interface>(i.lock());
-                            if (pi->get_name() == partInterfaceName)
-                            {
-                                partInterface = std::move(pi);
-                                break;
-                            }
-                        }
-                        if (!partInterface)
-                        {
-                            std::cerr << "ComponentModel::importFromBasicModelJSON(): Could not find internal interface " + partInterfaceName + " of part " + partName << std::endl;
-                            break;
-                        }
-                        // Found matching pair
-                        interface->alias_of(partInterface);
-                    }
-                    if (!found)
-                    {
-                        std::cerr << "ComponentModel::import_from_basic_model(): Could not find part " + partName + " in model " + model->get_name() << std::endl;
-                        error_occurred = true;
-                        break;
-                    }
-                }
+                ifModelName = modelIf["type"].get<std::string>();
+            }
+            // For the dynamic interfaces we set the default domain to the domain of the owning model. That will prevent issues with compatibility checking.
+            std::string ifModelDomain = model->get_domain();
+            if (modelIf.contains("domain"))
+            {
+                ifModelDomain = modelIf["domain"].get<std::string>();
             }
+            InterfaceModelPtr ifModel = resolve_basic_model_interface_model(ctx, ifModelName, ifModelDomain);
+            // Then we instantiate from it
+            DynamicInterfacePtr interface = ifModel->instantiate_dynamic(model); // HERE
+            // ... and update the properties
+            interface->set_properties(modelIf, false);
+        }
+    }
+    return true;
+}
+
+/**
+ * SAX handler which builds a DOM only for selected parts of a document.
+ * For every value the select function decides (by the path of keys and array indices leading to it) whether it is
+ * kept in the DOM, skipped (while still looking at its children), pruned (skipped completely) or captured.
+ * A captured value is built as a standalone DOM and handed over to on_capture as soon as it is complete. Afterwards it is released again.
+ */
+class BasicModelSax : public nl::json_sax< nl::json >
+{
+    public:
+        enum class Mode { KEEP, SKIP, PRUNE, CAPTURE };
+        using SelectFunc = std::function< Mode(const std::vector< std::string >&) >;
+        using CaptureFunc = std::function< void(const std::vector< std::string >&, nl::json&) >;
+
+        BasicModelSax(const SelectFunc& select, const CaptureFunc& on_capture) : m_select(select), m_on_capture(on_capture) {}
+
+        // The kept parts of the document
+        nl::json dom;
+
+        bool null() override { return this->value(nl::json(nullptr)); }
+        bool boolean(bool val) override { return this->value(nl::json(val)); }
+        bool number_integer(number_integer_t val) override { return this->value(nl::json(val)); }
+        bool number_unsigned(number_unsigned_t val) override { return this->value(nl::json(val)); }
+        bool number_float(number_float_t val, const string_t&) override { return this->value(nl::json(val)); }
+        bool string(string_t& val) override { return this->value(nl::json(std::move(val))); }
+        bool binary(binary_t& val) override { return this->value(nl::json::binary(std::move(val))); }
+        bool start_object(std::size_t) override { return this->start(nl::json::object()); }
+        bool start_array(std::size_t) override { return this->start(nl::json::array()); }
+        bool end_object() override { return this->end(); }
+        bool end_array() override { return this->end(); }
+        bool key(string_t& val) override
+        {
+            m_stack.back().key = val;
+            return true;
+        }
+        bool parse_error(std::size_t position, const std::string&, const nl::detail::exception& ex) override
+        {
+            throw std::invalid_argument("ComponentModel::import_from_basic_model(): Parse error at byte " + std::to_string(position) + ": " + ex.what());
         }
 
-        if (v.contains("dynamic_interfaces"))
+    private:
+        struct Frame
         {
-            for (const auto &modelIf : v["dynamic_interfaces"])
+            Mode mode;
+            // Where the children go (nullptr if they are not stored)
+            nl::json* target;
+            bool is_array;
+            std::string key;
+            std::size_t index = 0;
+        };
+        std::vector< Frame > m_stack;
+        std::vector< std::string > m_path;
+        // The captured value while it is being built
+        nl::json m_captured;
+        SelectFunc m_select;
+        CaptureFunc m_on_capture;
+
+        // Determines the mode of the next child of the current container and pushes its path
+        Mode enter(nl::json*& parent)
+        {
+            parent = nullptr;
+            if (m_stack.empty())
             {
-                // First, create the interface model (by type and domain)
-                std::string ifModelName = std::string("UNKNOWN");
-                if (modelIf.contains("type"))
-                {
-                    ifModelName = modelIf["type"].get<std::string>();
-                }
-                // For the dynamic interfaces we set the default domain to the domain of the owning model. That will prevent issues with compatibility checking.
-                std::string ifModelDomain = model->get_domain();
-                if (modelIf.contains("domain"))
+                m_path.clear();
+                return m_select(m_path);
+            }
+            Frame& frame(m_stack.back());
+            m_path.push_back(frame.is_array ? std::to_string(frame.index++) : frame.key);
+            parent = frame.target;
+            switch (frame.mode)
+            {
+                case Mode::CAPTURE:
+                    return Mode::CAPTURE;
+                case Mode::PRUNE:
+                    return Mode::PRUNE;
+                default:
+                    break;
+            }
+            const Mode mode(m_select(m_path));
+            // Values can only be kept if their parent is kept
+            if ((mode == Mode::KEEP) && (frame.mode != Mode::KEEP))
+                return Mode::SKIP;
+            return mode;
+        }
+
+        // Stores a child value and returns a pointer to it
+        nl::json* store(nl::json* parent, nl::json&& val)
+        {
+            if (!parent)
+                return nullptr;
+            if (parent->is_array())
+            {
+                parent->push_back(std::move(val));
+                return &parent->back();
+            }
+            nl::json& slot((*parent)[m_stack.back().key]);
+            slot = std::move(val);
+            return &slot;
+        }
+
+        bool value(nl::json&& val)
+        {
+            nl::json* parent;
+            const bool is_capture_root(m_stack.empty() || (m_stack.back().mode != Mode::CAPTURE));
+            const Mode mode(this->enter(parent));
+            if ((mode == Mode::CAPTURE) && is_capture_root)
+            {
+                m_on_capture(m_path, val);
+            } else if ((mode == Mode::KEEP) || (mode == Mode::CAPTURE)) {
+                if (m_stack.empty())
+                    dom = std::move(val);
+                else
+                    this->store(parent, std::move(val));
+            }
+            if (!m_stack.empty())
+                m_path.pop_back();
+            return true;
+        }
+
+        bool start(nl::json&& container)
+        {
+            const bool is_array(container.is_array());
+            nl::json* parent;
+            const bool is_capture_root(m_stack.empty() || (m_stack.back().mode != Mode::CAPTURE));
+            const Mode mode(this->enter(parent));
+            nl::json* target = nullptr;
+            if ((mode == Mode::CAPTURE) && is_capture_root)
+            {
+                m_captured = std::move(container);
+                target = &m_captured;
+            } else if ((mode == Mode::KEEP) || (mode == Mode::CAPTURE)) {
+                if (m_stack.empty())
                 {
-                    ifModelDomain = modelIf["domain"].get<std::string>();
+                    dom = std::move(container);
+                    target = &dom;
+                } else {
+                    target = this->store(parent, std::move(container));
                 }
-                // First create a dummy and try to load it before creating it new
-                InterfaceModel dummy;
-                dummy.set_properties({{"name", ifModelName},
-                                         {"domain", ifModelDomain}});
-                InterfaceModelPtr ifModel = std::static_pointer_cast<InterfaceModel>(registry->load_by_uri(dummy.uri()));
-                if (!ifModel)
+            }
+            m_stack.push_back({mode, target, is_array, "", 0});
+            return true;
+        }
+
+        bool end()
+        {
+            const Frame frame(m_stack.back());
+            m_stack.pop_back();
+            if ((frame.mode == Mode::CAPTURE) && (frame.target == &m_captured))
+            {
+                m_on_capture(m_path, m_captured);
+                m_captured = nl::json();
+            }
+            if (!m_stack.empty())
+                m_path.pop_back();
+            return true;
+        }
+};
+
+// A source of a serialized model which can be read multiple times
+using BasicModelSource = std::function< void(BasicModelSax&) >;
+
+// Imports the versions of a serialized model while reading it
+// The source is read in three passes:
+// 1. the document without the components of the versions (which is small), to create the models
+//    If the registry has a batch load hook, the models of the parts are collected as well, so that all referenced models can be loaded at once
+// 2. the parts of the versions (one by one)
+// 3. the connections and configurations of the versions (one by one)
+// Afterwards the (dynamic) interfaces are created.
+// NOTE: The versions are not imported one after another. All models are created first, then the parts, connections and interfaces of all versions.
+// The facts of every model are added in the same order as by a version by version import, but objects of different versions are created interleaved.
+// If with_options contains 'parallel': true, the components of all versions are kept after the second pass instead and the versions are imported concurrently.
+// NOTE: Every pass parses the source again, so a string or seekable stream is parsed three times (twice for parallel imports). Only the memory is saved.
+static std::vector<ComponentModelPtr> import_basic_model_streamed(const BasicModelSource& read, const XTypeRegistryPtr& registry, const nl::json& with_options)
+{
+    // NOTE: The properties of existing models may get overwritten through the XType interface
+    count_model_modification();
+    using Mode = BasicModelSax::Mode;
+    // Path of a value inside a version: versions/<index>/...
+    auto in_version = [](const std::vector< std::string >& path, const std::vector< std::string >& suffix) -> bool
+    {
+        if ((path.size() != suffix.size() + 2) || (path[0] != "versions"))
+            return false;
+        return std::equal(suffix.begin(), suffix.end(), path.begin() + 2);
+    };
+
+    // Pass 1: Everything but the components (and the models of the parts if they can be prefetched)
+    const bool prefetch(get_batch_load_func(registry) != nullptr);
+    std::set< std::size_t > with_components;
+    std::vector< nl::json > part_models;
+    BasicModelSax skeleton_sax([&](const std::vector< std::string >& path) -> Mode {
+        if (in_version(path, {"components"}))
+        {
+            with_components.insert(std::stoul(path[1]));
+            return prefetch ? Mode::SKIP : Mode::PRUNE;
+        }
+        if ((path.size() > 3) && (path[0] == "versions") && (path[2] == "components"))
+        {
+            // versions/<index>/components/nodes/<index>/model
+            if ((path[3] != "nodes") || (path.size() > 6) || ((path.size() == 6) && (path[5] != "model")))
+                return Mode::PRUNE;
+            return (path.size() == 6) ? Mode::CAPTURE : Mode::SKIP;
+        }
+        return Mode::KEEP;
+    }, [&](const std::vector< std::string >&, nl::json& model) {
+        part_models.push_back(std::move(model));
+    });
+    read(skeleton_sax);
+    nl::json& data(skeleton_sax.dom);
+    if (!data.is_object())
+    {
+        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Expected an object but got " + data.dump());
+    }
+
+    BasicModelImport ctx;
+    ctx.registry = registry;
+    // Load all referenced models at once before they are resolved one by one
+    if (prefetch)
+        prefetch_basic_model_references(ctx, collect_basic_model_references(data, part_models));
+    part_models.clear();
+    begin_basic_model_import(ctx, data);
+    if (!data.contains("versions"))
+    {
+        throw std::invalid_argument("ComponentModel::import_from_basic_model(): Could not find 'versions' in " + ctx.data.dump());
+    }
+
+    // Create model(s)
+    struct VersionState
+    {
+        ComponentModelPtr model;
+        BasicModelParts parts;
+        bool error_occurred = false;
+        // The lists of the components are processed until their first error
+        bool nodes_stopped = false;
+        bool edges_stopped = false;
+        // The configurations need the parts and connections, so they are kept until all edges have been imported
+        std::vector< nl::json > configuration_nodes;
+        std::vector< nl::json > configuration_edges;
+        // Only used for parallel imports: The parts and connections in document order and the deferred links
+        std::vector< nl::json > nodes;
+        std::vector< nl::json > edges;
+        BasicModelLinks links;
+    };
+    const nl::json& versions(data["versions"]);
+    std::vector< VersionState > states(versions.size());
+    for (std::size_t index = 0; index < versions.size(); ++index)
+        states[index].model = create_basic_model_version(ctx, versions[index]);
+
+    auto state_of = [&](const std::vector< std::string >& path) -> VersionState*
+    {
+        const std::size_t index(std::stoul(path[1]));
+        return ((index < states.size()) && states[index].model) ? &states[index] : nullptr;
+    };
+    auto route_to = [&](const std::vector< std::string >& path, const std::vector< std::vector< std::string > >& targets) -> Mode
+    {
+        // Skip the containers on the way to the targets, capture the elements of the targets and prune everything else
+        if (path.size() < 1)
+            return Mode::SKIP;
+        if (path[0] != "versions")
+            return Mode::PRUNE;
+        if (path.size() < 3)
+            return Mode::SKIP;
+        const std::vector< std::string > rest(path.begin() + 2, path.end());
+        for (const auto& target : targets)
+        {
+            if ((rest.size() <= target.size()) && std::equal(rest.begin(), rest.end(), target.begin()))
+                return Mode::SKIP;
+            if ((rest.size() == target.size() + 1) && std::equal(target.begin(), target.end(), rest.begin()))
+                return state_of(path) ? Mode::CAPTURE : Mode::PRUNE;
+        }
+        return Mode::PRUNE;
+    };
+
+    // Applies the configurations of a version (in the same order as the non-streamed import: nodes first, then edges)
+    auto configure = [](VersionState& state)
+    {
+        for (const auto& config : state.configuration_nodes)
+        {
+            if (!import_basic_model_part_configuration(state.model, config, state.parts))
+            {
+                state.error_occurred = true;
+                break;
+            }
+        }
+        if (!import_basic_model_edge_configurations(state.model, state.configuration_edges, state.parts))
+            state.error_occurred = true;
+        state.configuration_nodes.clear();
+        state.configuration_edges.clear();
+    };
+
+    const bool in_parallel(with_options.value("parallel", false));
+    if ((with_components.size() > 0) && in_parallel)
+    {
+        // Pass 2: Keep the components of all versions
+        BasicModelSax components_sax([&](const std::vector< std::string >& path) -> Mode {
+            return route_to(path, {{"components", "nodes"}, {"components", "edges"}, {"components", "configuration", "nodes"}, {"components", "configuration", "edges"}});
+        }, [&](const std::vector< std::string >& path, nl::json& value) {
+            VersionState& state(*state_of(path));
+            const std::vector< std::string > list(path.begin(), path.end() - 1);
+            if (in_version(list, {"components", "nodes"}))
+                state.nodes.push_back(std::move(value));
+            else if (in_version(list, {"components", "edges"}))
+                state.edges.push_back(std::move(value));
+            else if (in_version(list, {"components", "configuration", "nodes"}))
+                state.configuration_nodes.push_back(std::move(value));
+            else
+                state.configuration_edges.push_back(std::move(value));
+        });
+        read(components_sax);
+
+        // Resolve the part models and instantiate the parts up front, so that the import context is only read and the registry is not touched while the versions are imported
+        // NOTE: Like the serial import, this stops at the first part of a version whose model cannot be resolved
+        for (auto& state : states)
+        {
+            if (!state.model)
+                continue;
+            for (const auto& part : state.nodes)
+            {
+                if (!part.contains("model") || !part["model"].contains("name") || !part["model"].contains("domain") || !part["model"].contains("version"))
+                    break;
+                const ComponentModelPtr part_model(resolve_basic_model_part_model(ctx, part));
+                if (!part_model)
+                    break;
+                state.links.instantiate(ctx.registry, part_model);
+            }
+        }
+
+        // Create the parts of the versions concurrently
+        // NOTE: The models of the parts and interfaces are shared, so linking to them is deferred
+        const int max_threads(with_options.value("max_threads", 0));
+        for_each_in_parallel(states.size(), max_threads, [&](const std::size_t index) {
+            VersionState& state(states[index]);
+            if (!state.model)
+                return;
+            for (const auto& part : state.nodes)
+            {
+                if (!import_basic_model_part(ctx, state.model, part, state.parts, state.error_occurred, &state.links))
                 {
-                    // create a new interface model
-                    ifModel = registry->instantiate<InterfaceModel>();
-                    ifModel->set_properties(dummy.get_properties());
+                    state.error_occurred = true;
+                    break;
                 }
-                // Then we instantiate from it
-                DynamicInterfacePtr interface = ifModel->instantiate_dynamic(model); // HERE
-                // ... and update the properties
-                interface->set_properties(modelIf, false);
             }
+            state.nodes.clear();
+        });
+        // Link the parts to their models in the order of the versions
+        for (auto& state : states)
+        {
+            state.links.apply();
+            state.links = BasicModelLinks();
+        }
+        // Connect and configure the parts of the versions concurrently (this only touches the objects of a version)
+        for_each_in_parallel(states.size(), max_threads, [&](const std::size_t index) {
+            VersionState& state(states[index]);
+            if (!state.model)
+                return;
+            for (const auto& edge : state.edges)
+            {
+                // NOTE: Like in the non-streamed case, a successful connection resets the error state
+                state.error_occurred = !import_basic_model_edge(edge, state.parts);
+                if (state.error_occurred)
+                    break;
+            }
+            state.edges.clear();
+            configure(state);
+        });
+    } else if (with_components.size() > 0) {
+        // Pass 2: Handling parts
+        BasicModelSax parts_sax([&](const std::vector< std::string >& path) -> Mode {
+            return route_to(path, {{"components", "nodes"}});
+        }, [&](const std::vector< std::string >& path, nl::json& part) {
+            VersionState& state(*state_of(path));
+            if (state.nodes_stopped)
+                return;
+            if (!import_basic_model_part(ctx, state.model, part, state.parts, state.error_occurred))
+            {
+                state.error_occurred = true;
+                state.nodes_stopped = true;
+            }
+        });
+        read(parts_sax);
+
+        // Pass 3: Handle connections and configuration
+        BasicModelSax edges_sax([&](const std::vector< std::string >& path) -> Mode {
+            return route_to(path, {{"components", "edges"}, {"components", "configuration", "nodes"}, {"components", "configuration", "edges"}});
+        }, [&](const std::vector< std::string >& path, nl::json& value) {
+            VersionState& state(*state_of(path));
+            if (in_version(std::vector< std::string >(path.begin(), path.end() - 1), {"components", "edges"}))
+            {
+                if (state.edges_stopped)
+                    return;
+                // NOTE: Like in the non-streamed case, a successful connection resets the error state
+                state.error_occurred = !import_basic_model_edge(value, state.parts);
+                state.edges_stopped = state.error_occurred;
+            } else if (in_version(std::vector< std::string >(path.begin(), path.end() - 1), {"components", "configuration", "nodes"})) {
+                // NOTE: Documents may list the configuration before the edges (e.g. with sorted keys), so configurations are applied after all edges have been read
+                state.configuration_nodes.push_back(std::move(value));
+            } else {
+                state.configuration_edges.push_back(std::move(value));
+            }
+        });
+        read(edges_sax);
+        for (auto& state : states)
+        {
+            if (state.model)
+                configure(state);
         }
+    }
 
-        if (error_occurred)
+    std::vector<ComponentModelPtr> result;
+    for (std::size_t index = 0; index < states.size(); ++index)
+    {
+        VersionState& state(states[index]);
+        if (!state.model)
+            continue;
+        if (!import_basic_model_interfaces(ctx, state.model, versions[index], state.parts))
+            state.error_occurred = true;
+        if (state.error_occurred)
         {
-            std::cerr << "ComponentModel::import_from_basic_model(): Error ocurred while parsing " << domain << " " << name << " " << version << ". Skipping it.\n";
+            std::cerr << "ComponentModel::import_from_basic_model(): Error ocurred while parsing " << ctx.domain << " " << ctx.name << " " << versions[index]["name"].get<std::string>() << ". Skipping it.\n";
             continue;
         }
 
         // Add VALID component model to result
-        result.push_back(std::move(model));
+        result.push_back(std::move(state.model));
     }
     return result;
 }
 
+std::vector<ComponentModelPtr> xtypes::ComponentModel::import_from_basic_model(const std::string &serialized_model, const XTypeRegistryPtr &registry, const nl::json &with_options)
+{
+    return import_basic_model_streamed([&](BasicModelSax& sax) {
+        nl::json::sax_parse(serialized_model.begin(), serialized_model.end(), &sax);
+    }, registry, with_options);
+}
+
+// Returns the input format of nlohmann::json for an encoding
+static nl::json::input_format_t input_format_of(const BasicModelEncoding encoding)
+{
+    switch (encoding)
+    {
+        case BasicModelEncoding::CBOR:
+            return nl::json::input_format_t::cbor;
+        case BasicModelEncoding::MSGPACK:
+            return nl::json::input_format_t::msgpack;
+        default:
+            break;
+    }
+    return nl::json::input_format_t::json;
+}
+
+std::vector<ComponentModelPtr> xtypes::import_from_basic_model(const std::vector<std::uint8_t> &encoded_model, const BasicModelEncoding encoding, const XTypeRegistryPtr &registry, const nl::json &with_options)
+{
+    return import_basic_model_streamed([&](BasicModelSax& sax) {
+        nl::json::sax_parse(encoded_model.begin(), encoded_model.end(), &sax, input_format_of(encoding));
+    }, registry, with_options);
+}
+
+std::vector<ComponentModelPtr> xtypes::ComponentModel::import_from_basic_model_file(const std::string &path, const XTypeRegistryPtr &registry, const nl::json &with_options)
+{
+    return import_basic_model_streamed([&](BasicModelSax& sax) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            throw std::invalid_argument("ComponentModel::import_from_basic_model_file(): Could not open " + path);
+        }
+        nl::json::sax_parse(in, &sax);
+    }, registry, with_options);
+}
+
+// Validates a serialized model without creating any xtypes (the referenced models are loaded though)
+// The source is read in the same three passes as by import_basic_model_streamed(). Every problem is reported as {"path": <JSON pointer>, "message": <STRING>}.
+static nl::json validate_basic_model_streamed(const BasicModelSource& read, const XTypeRegistryPtr& registry)
+{
+    using Mode = BasicModelSax::Mode;
+    nl::json errors = nl::json::array();
+    auto pointer_of = [](const std::vector< std::string >& path) -> std::string
+    {
+        std::string pointer;
+        for (const auto& key : path)
+            pointer += "/" + key;
+        return pointer;
+    };
+    auto report = [&](const std::string& pointer, const std::string& message)
+    {
+        errors.push_back({{"path", pointer}, {"message", message}});
+    };
+    auto is_string = [](const nl::json& entry, const std::string& key) -> bool
+    {
+        return entry.is_object() && entry.contains(key) && entry[key].is_string();
+    };
+    // Reads the source and reports syntax errors. Returns false on error.
+    auto read_checked = [&](BasicModelSax& sax) -> bool
+    {
+        try
+        {
+            read(sax);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            // Syntax errors are reported by the BasicModelSax
+            report("", e.what());
+            return false;
+        }
+        return true;
+    };
+
+    // Reports a value which exists but is not of the given type (array or object). Returns false in that case.
+    auto has_type = [&](const nl::json& parent, const std::string& key, const nl::json::value_t type, const std::string& pointer) -> bool
+    {
+        if (!parent.is_object() || !parent.contains(key) || (parent[key].type() == type))
+            return true;
+        report(pointer + "/" + key, std::string("Expected ") + ((type == nl::json::value_t::array) ? "an array" : "an object"));
+        return false;
+    };
+
+    // Pass 1: Everything but the entries of the components
+    // NOTE: The lists of the components are kept (empty), so that their types can be checked
+    BasicModelSax skeleton_sax([&](const std::vector< std::string >& path) -> Mode {
+        if ((path.size() < 4) || (path[0] != "versions") || (path[2] != "components"))
+            return Mode::KEEP;
+        return ((path.size() == 4) || ((path.size() == 5) && (path[3] == "configuration"))) ? Mode::KEEP : Mode::PRUNE;
+    }, nullptr);
+    if (!read_checked(skeleton_sax))
+        return errors;
+    const nl::json& data(skeleton_sax.dom);
+    if (!data.is_object())
+    {
+        report("", "Expected an object");
+        return errors;
+    }
+    for (const std::string key : {"name", "domain"})
+        if (!is_string(data, key))
+            report("/" + key, "Missing or invalid '" + key + "'");
+    if (!data.contains("versions") || !data["versions"].is_array())
+    {
+        report("/versions", "Missing or invalid 'versions'");
+        return errors;
+    }
+    if (data.contains("types") && has_type(data, "types", nl::json::value_t::array, ""))
+    {
+        for (std::size_t index = 0; index < data["types"].size(); ++index)
+            for (const std::string key : {"name", "version"})
+                if (!is_string(data["types"][index], key))
+                    report("/types/" + std::to_string(index) + "/" + key, "Missing or invalid '" + key + "'");
+    }
+    if (data.contains("configured_for") && has_type(data, "configured_for", nl::json::value_t::array, ""))
+    {
+        for (std::size_t index = 0; index < data["configured_for"].size(); ++index)
+            if (!is_string(data["configured_for"][index], "uri"))
+                report("/configured_for/" + std::to_string(index) + "/uri", "Missing or invalid 'uri'");
+    }
+
+    // The parts of a version with the interfaces of their models (nullptr if the model could not be loaded)
+    using InterfacesByName = std::unordered_map< std::string, InterfacePtr >;
+    struct VersionState
+    {
+        bool valid = false;
+        std::unordered_map< std::string, const InterfacesByName* > parts;
+        // The number of connections per part interface (part name, interface name) and the connections which have been seen
+        std::map< std::pair< std::string, std::string >, std::size_t > connections_of;
+        std::set< std::vector< std::string > > connections;
+        std::set< std::string > connection_names;
+        // The configured connections (path, name) which can only be checked after all connections have been seen
+        std::vector< std::pair< std::string, std::string > > configured_connections;
+    };
+    const nl::json& versions(data["versions"]);
+    std::vector< VersionState > states(versions.size());
+    for (std::size_t index = 0; index < versions.size(); ++index)
+    {
+        // NOTE: Versions with lists of the wrong type are not checked any further
+        const std::string pointer("/versions/" + std::to_string(index));
+        const nl::json& version(versions[index]);
+        if (!version.is_object())
+        {
+            report(pointer, "Expected an object");
+            continue;
+        }
+        bool valid = is_string(version, "name");
+        if (!valid)
+            report(pointer + "/name", "Missing or invalid 'name'");
+        for (const std::string kind : {"interfaces", "dynamic_interfaces"})
+            valid = has_type(version, kind, nl::json::value_t::array, pointer) && valid;
+        if (!has_type(version, "components", nl::json::value_t::object, pointer))
+        {
+            valid = false;
+        } else if (version.contains("components")) {
+            const nl::json& components(version["components"]);
+            for (const std::string list : {"nodes", "edges"})
+                valid = has_type(components, list, nl::json::value_t::array, pointer + "/components") && valid;
+            if (!has_type(components, "configuration", nl::json::value_t::object, pointer + "/components"))
+                valid = false;
+            else if (components.contains("configuration"))
+                for (const std::string list : {"nodes", "edges"})
+                    valid = has_type(components["configuration"], list, nl::json::value_t::array, pointer + "/components/configuration") && valid;
+        }
+        states[index].valid = valid;
+    }
+    auto state_of = [&](const std::vector< std::string >& path) -> VersionState*
+    {
+        const std::size_t index(std::stoul(path[1]));
+        return ((index < states.size()) && states[index].valid) ? &states[index] : nullptr;
+    };
+    // Selects the elements of the given lists of the components of the versions
+    auto select = [&](const std::vector< std::vector< std::string > >& lists) -> BasicModelSax::SelectFunc
+    {
+        return [&, lists](const std::vector< std::string >& path) -> Mode {
+            if (path.size() < 1)
+                return Mode::SKIP;
+            if (path[0] != "versions")
+                return Mode::PRUNE;
+            if (path.size() < 3)
+                return Mode::SKIP;
+            const std::vector< std::string > rest(path.begin() + 2, path.end());
+            for (const auto& list : lists)
+            {
+                if ((rest.size() <= list.size()) && std::equal(rest.begin(), rest.end(), list.begin()))
+                    return Mode::SKIP;
+                if ((rest.size() == list.size() + 1) && std::equal(list.begin(), list.end(), rest.begin()))
+                    return state_of(path) ? Mode::CAPTURE : Mode::PRUNE;
+            }
+            return Mode::PRUNE;
+        };
+    };
+
+    // Pass 2: The parts and their models
+    BasicModelImport ctx;
+    ctx.registry = registry;
+    std::map< ComponentModelPtr, InterfacesByName > interfaces_of_models;
+    BasicModelSax parts_sax(select({{"components", "nodes"}}), [&](const std::vector< std::string >& path, nl::json& part) {
+        VersionState& state(*state_of(path));
+        const std::string pointer(pointer_of(path));
+        if (!is_string(part, "name"))
+        {
+            report(pointer + "/name", "Missing or invalid 'name'");
+            return;
+        }
+        const std::string name(part["name"].get<std::string>());
+        if (state.parts.count(name))
+            report(pointer + "/name", "Duplicate part " + name);
+        if (!part.contains("model") || !is_string(part["model"], "name") || !is_string(part["model"], "domain") || !is_string(part["model"], "version"))
+        {
+            report(pointer + "/model", "Missing or invalid 'model' (needs 'name', 'domain' and 'version')");
+            state.parts[name] = nullptr;
+            return;
+        }
+        const ComponentModelPtr model(resolve_basic_model_part_model(ctx, part));
+        if (!model)
+        {
+            report(pointer + "/model", "Could not load model " + part["model"]["name"].get<std::string>() + " " + part["model"]["version"].get<std::string>());
+            state.parts[name] = nullptr;
+            return;
+        }
+        auto it(interfaces_of_models.find(model));
+        if (it == interfaces_of_models.end())
+        {
+            InterfacesByName interfaces;
+            for (const auto &[i, _] : known_facts_of(*model, "interfaces"))
+            {
+                InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+                interfaces.emplace(interface->get_name(), std::move(interface));
+            }
+            it = interfaces_of_models.emplace(model, std::move(interfaces)).first;
+        }
+        state.parts[name] = &it->second;
+        if (part.contains("interface_aliases") && part["interface_aliases"].is_object())
+        {
+            for (const auto& [interface_name, _] : part["interface_aliases"].items())
+                if (!it->second.count(interface_name))
+                    report(pointer + "/interface_aliases/" + interface_name, "Part " + name + " has no interface " + interface_name);
+        }
+    });
+    if (!read_checked(parts_sax))
+        return errors;
+
+    // Resolves a part interface of a connection (reports errors and returns nullptr if it cannot be resolved)
+    auto endpoint_of = [&](VersionState& state, const nl::json& edge, const std::string& pointer, const std::string& end, std::pair< std::string, std::string >& ref) -> InterfacePtr
+    {
+        if (!edge.contains(end) || !is_string(edge[end], "name") || !is_string(edge[end], "interface"))
+        {
+            report(pointer + "/" + end, "Missing or invalid '" + end + "' (needs 'name' and 'interface')");
+            return nullptr;
+        }
+        ref = {edge[end]["name"].get<std::string>(), edge[end]["interface"].get<std::string>()};
+        const auto& part(state.parts.find(ref.first));
+        if (part == state.parts.end())
+        {
+            report(pointer + "/" + end + "/name", "Could not find part " + ref.first);
+            return nullptr;
+        }
+        // NOTE: Parts with invalid models have been reported already
+        if (!part->second)
+            return nullptr;
+        const auto& interface(part->second->find(ref.second));
+        if (interface == part->second->end())
+        {
+            report(pointer + "/" + end + "/interface", "Part " + ref.first + " has no interface " + ref.second);
+            return nullptr;
+        }
+        return interface->second;
+    };
+
+    // Pass 3: The connections and configurations
+    BasicModelSax edges_sax(select({{"components", "edges"}, {"components", "configuration", "nodes"}, {"components", "configuration", "edges"}}), [&](const std::vector< std::string >& path, nl::json& value) {
+        VersionState& state(*state_of(path));
+        const std::string pointer(pointer_of(path));
+        const std::string list(path[path.size() - 2]);
+        if (path[3] == "configuration")
+        {
+            // NOTE: Like the import, entries without a name are ignored
+            if (!is_string(value, "name"))
+                return;
+            const std::string name(value["name"].get<std::string>());
+            if (list == "edges")
+                state.configured_connections.push_back({pointer + "/name", name});
+            else if (!state.parts.count(name))
+                report(pointer + "/name", "Could not find part " + name);
+            return;
+        }
+        std::pair< std::string, std::string > from_ref, to_ref;
+        const InterfacePtr from(endpoint_of(state, value, pointer, "from", from_ref));
+        const InterfacePtr to(endpoint_of(state, value, pointer, "to", to_ref));
+        if (is_string(value, "name"))
+            state.connection_names.insert(value["name"].get<std::string>());
+        if (!from || !to)
+            return;
+        // Connecting the same interfaces again has no effect
+        if (!state.connections.insert({from_ref.first, from_ref.second, to_ref.first, to_ref.second}).second)
+            return;
+        const InterfaceModelPtr from_type(from->get_type());
+        const InterfaceModelPtr to_type(to->get_type());
+        if (from_type && to_type && (from_type->uuid() != to_type->uuid()))
+            report(pointer, "Type mismatch between " + from_ref.first + ":" + from_ref.second + " (" + from_type->get_name() + ") and " + to_ref.first + ":" + to_ref.second + " (" + to_type->get_name() + ")");
+        const std::string from_direction(from->get_direction());
+        const std::string to_direction(to->get_direction());
+        if (!Interface::have_compatible_directions(from_direction, to_direction))
+            report(pointer, "Direction mismatch between " + from_ref.first + ":" + from_ref.second + " (" + from_direction + ") and " + to_ref.first + ":" + to_ref.second + " (" + to_direction + ")");
+        for (const auto& [ref, interface] : {std::make_pair(from_ref, from), std::make_pair(to_ref, to)})
+        {
+            if ((++state.connections_of[ref] > 1) && (interface->get_multiplicity() == "ONE"))
+                report(pointer, "Multiplicity of " + ref.first + ":" + ref.second + " is violated (ONE)");
+        }
+    });
+    if (!read_checked(edges_sax))
+        return errors;
+
+    for (std::size_t index = 0; index < states.size(); ++index)
+    {
+        VersionState& state(states[index]);
+        if (!state.valid)
+            continue;
+        for (const auto& [pointer, name] : state.configured_connections)
+            if (!state.connection_names.count(name))
+                report(pointer, "Could not find connection " + name);
+        // The aliases of the interfaces of the model
+        for (const std::string kind : {"interfaces", "dynamic_interfaces"})
+        {
+            if (!versions[index].contains(kind))
+                continue;
+            const nl::json& interfaces(versions[index][kind]);
+            for (std::size_t i = 0; i < interfaces.size(); ++i)
+            {
+                const std::string pointer("/versions/" + std::to_string(index) + "/" + kind + "/" + std::to_string(i));
+                if ((kind == "interfaces") && !is_string(interfaces[i], "name"))
+                    report(pointer + "/name", "Missing or invalid 'name'");
+                if ((kind != "interfaces") || !is_string(interfaces[i], "linkToNode") || !is_string(interfaces[i], "linkToInterface"))
+                    continue;
+                const std::string part_name(interfaces[i]["linkToNode"].get<std::string>());
+                const std::string interface_name(interfaces[i]["linkToInterface"].get<std::string>());
+                const auto& part(state.parts.find(part_name));
+                if (part == state.parts.end())
+                    report(pointer + "/linkToNode", "Could not find part " + part_name);
+                else if (part->second && !part->second->count(interface_name))
+                    report(pointer + "/linkToInterface", "Part " + part_name + " has no interface " + interface_name);
+            }
+        }
+    }
+    return errors;
+}
+
+nl::json xtypes::ComponentModel::validate_basic_model(const std::string &serialized_model, const XTypeRegistryPtr &registry)
+{
+    return validate_basic_model_streamed([&](BasicModelSax& sax) {
+        nl::json::sax_parse(serialized_model.begin(), serialized_model.end(), &sax);
+    }, registry);
+}
+
+nl::json xtypes::ComponentModel::validate_basic_model_file(const std::string &path, const XTypeRegistryPtr &registry)
+{
+    if (!std::ifstream(path, std::ios::binary))
+    {
+        return nl::json::array({{{"path", ""}, {"message", "Could not open " + path}}});
+    }
+    return validate_basic_model_streamed([&](BasicModelSax& sax) {
+        std::ifstream in(path, std::ios::binary);
+        nl::json::sax_parse(in, &sax);
+    }, registry);
+}
+
+std::vector<ComponentModelPtr> xtypes::import_from_basic_model(std::istream &in, const XTypeRegistryPtr &registry, const nl::json &with_options, const BasicModelEncoding encoding)
+{
+    const std::istream::pos_type start(in.tellg());
+    if (start == std::istream::pos_type(-1))
+    {
+        // The stream cannot be rewound, so we have to keep its content
+        const std::vector<std::uint8_t> encoded_model((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return import_from_basic_model(encoded_model, encoding, registry, with_options);
+    }
+    return import_basic_model_streamed([&](BasicModelSax& sax) {
+        in.clear();
+        in.seekg(start);
+        nl::json::sax_parse(in, &sax, input_format_of(encoding));
+    }, registry, with_options);
+}
+
 InterfacePtr xtypes::ComponentModel::export_inner_interface(xtypes::InterfacePtr inner_interface, const bool& with_empty_facts)
 {
     const auto inner_interface_name = inner_interface->get_name();
@@ -1504,6 +3723,7 @@ void xtypes::ComponentModel::annotate_with(const ExternalReferencePtr reference,
 {
     nl::json edge_properties = {{"optional", optional}};
     this->add_external_references(reference, edge_properties);
+    count_model_modification();
 }
 
 void xtypes::ComponentModel::add_parts(xtypes::ComponentCPtr xtype, const nl::json& props)
@@ -1524,6 +3744,7 @@ void xtypes::ComponentModel::add_abstracts(xtypes::ComponentModelCPtr xtype, con
     {
         throw std::runtime_error("xtypes::ComponentModel::add_abstracts(): This ComponentModel is not a valid implementation of superclass");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_ComponentModel::add_abstracts(xtype, props);
 }
@@ -1535,6 +3756,7 @@ void xtypes::ComponentModel::add_implementations(xtypes::ComponentModelCPtr xtyp
     {
         throw std::runtime_error("xtypes::ComponentModel::add_implementations(): Given xtype is not a valid implementation for us");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_ComponentModel::add_implementations(xtype, props);
 }
@@ -1550,6 +3772,7 @@ void xtypes::ComponentModel::add_configured_for(xtypes::ComponentModelCPtr xtype
     {
         throw std::runtime_error("xtypes::ComponentModel::add_configured_for(): Given xtype is not valid for configuration");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_ComponentModel::add_configured_for(xtype, props);
 }
@@ -1560,6 +3783,7 @@ void xtypes::ComponentModel::add_deployables(xtypes::ComponentModelCPtr xtype, c
     {
         throw std::runtime_error("xtypes::ComponentModel::add_deployables(): Given xtype is not valid for deployment");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_ComponentModel::add_deployables(xtype, props);
 }
@@ -1583,5 +3807,6 @@ void xtypes::ComponentModel::remove_configured_for(ComponentModelPtr hardware)
 {
     // Unlink this SOFTWARE with hardware ASSEMBLY
     hardware->remove_fact("deployables", std::static_pointer_cast<ComponentModel>(shared_from_this()));
+    count_model_modification();
 
 }
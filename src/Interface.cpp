@@ -6,7 +6,12 @@
 #include "DynamicInterface.hpp"
 #include "InterfaceModel.hpp"
 #include "Module.hpp"
+#include "BuildPlan.hpp"
+#include <algorithm>
 #include <iostream>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace xtypes;
 
@@ -19,6 +24,42 @@ xtypes::Interface::Interface(const std::string &classname) : _Interface(classnam
 // Static identifier
 const std::string xtypes::Interface::classname = "xtypes::Interface";
 
+// Returns the parent of an interface if it is a module
+static ModulePtr module_parent_of(const Interface& interface)
+{
+    if (!interface.has_facts("parent") || interface.get_facts("parent").empty())
+        return nullptr;
+    return std::dynamic_pointer_cast<Module>(interface.get_facts("parent")[0].target.lock());
+}
+
+// Counts a modification of the models if the interface belongs to one (interfaces of modules do not)
+static void count_model_modification_of(const Interface& interface)
+{
+    if (!interface.has_facts("parent") || interface.get_facts("parent").empty())
+        return;
+    if (!module_parent_of(interface))
+        count_model_modification();
+}
+
+// The inputs of _Interface::uri() are the parent, the name and the direction
+CachedUri::Inputs xtypes::Interface::uri_inputs(const ModulePtr& parent) const
+{
+    CachedUri::Inputs inputs;
+    inputs.parent = &this->facts.at("parent")[0].target;
+    inputs.parent_version = parent->uri_version();
+    inputs.name = &this->properties.at("name");
+    inputs.direction = &this->properties.at("direction");
+    return inputs;
+}
+
+std::string xtypes::Interface::uri() const
+{
+    ModulePtr parent(module_parent_of(*this));
+    if (!parent)
+        return this->_Interface::uri();
+    return m_cached_uri.get(this->uri_inputs(parent), [this]() { return this->_Interface::uri(); });
+}
+
 // Method implementations
 // This function returns the domain of the interface
 std::string xtypes::Interface::get_domain()
@@ -60,18 +101,13 @@ void xtypes::Interface::child_of(const xtypes::XTypePtr parent)
 void xtypes::Interface::alias_of(const InterfacePtr interface)
 {
     this->add_original(interface);
+    count_model_modification_of(*this);
 }
 
 // Returns true if this interface is connected to the other interface
 bool xtypes::Interface::is_connected_to(const InterfacePtr other)
 {
-    for (const auto& [i,_] : get_facts("others"))
-    {
-        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
-        if (interface->uri() == other->uri())
-            return true;
-    }
-    return false;
+    return this->has_peer("others", other);
 }
 
 // This function first checks if the interfaces can be connected. If so, they get connected.
@@ -90,32 +126,158 @@ bool xtypes::Interface::connected_to(const InterfacePtr interface, const nl::jso
         return false;
     }
 
-    // NOTE: Our setters have been disabled and would throw, so we have to call the base class functions here
-    this->_Interface::add_others(interface, properties);
+    // NOTE: Our setters have been disabled and would throw. The base class functions scan all existing facts, so the fact and its inverse are appended directly.
+    this->append_peer("others", interface, properties);
+    interface->append_peer("from_others", shared_from_this(), properties);
+    count_model_modification_of(*this);
     return true;
 }
 
+// Returns true if interfaces with the given directions can be connected
+bool xtypes::Interface::have_compatible_directions(const std::string& from, const std::string& to)
+{
+    if ((from == "OUTGOING" && to == "INCOMING") ||
+        (from == "INCOMING" && to == "OUTGOING")
+    )
+        return true;
+    else if (from == "BIDIRECTIONAL" && to == "BIDIRECTIONAL")
+        return true;
+    else if (from == "DIRECTION_NOT_SET" && to == "DIRECTION_NOT_SET")
+        return true;
+    return false;
+}
+
+// Connects many pairs of interfaces at once. All of them are checked before any of them gets connected.
+nl::json xtypes::Interface::connect_all(const std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > >& connections)
+{
+    nl::json rejected = nl::json::array();
+    // The type uuids and the number of connections (including the ones accepted so far) of the interfaces involved
+    std::unordered_map< const Interface*, std::size_t > type_uuids;
+    std::unordered_map< const Interface*, std::size_t > n_connections;
+    auto type_uuid_of = [&](const InterfacePtr& interface) -> std::size_t
+    {
+        const auto& it(type_uuids.find(interface.get()));
+        if (it != type_uuids.end())
+            return it->second;
+        const InterfaceModelPtr type(interface->get_type());
+        return type_uuids[interface.get()] = (type ? type->uuid() : 0);
+    };
+    auto n_connections_of = [&](const InterfacePtr& interface) -> std::size_t&
+    {
+        const auto& it(n_connections.find(interface.get()));
+        if (it != n_connections.end())
+            return it->second;
+        std::size_t n = 0;
+        for (const std::string relation : {"others", "from_others"})
+            n += interface->has_facts(relation) ? interface->get_facts(relation).size() : 0;
+        return n_connections[interface.get()] = n;
+    };
+
+    std::set< std::pair< const Interface*, const Interface* > > accepted;
+    std::vector< std::size_t > to_be_added;
+    for (std::size_t index = 0; index < connections.size(); ++index)
+    {
+        const auto& [from, to, properties] = connections[index];
+        auto reject = [&](const std::string& reason)
+        {
+            rejected.push_back({{"index", index}, {"from", from ? from->uri() : ""}, {"to", to ? to->uri() : ""}, {"reason", reason}});
+        };
+        if (!from || !to)
+        {
+            reject("Missing interface");
+            continue;
+        }
+        // Existing connections are kept (like connected_to() does)
+        if (accepted.count({from.get(), to.get()}) || from->is_connected_to(to))
+            continue;
+        if ((type_uuid_of(from) == 0) || (type_uuid_of(from) != type_uuid_of(to)))
+        {
+            reject("Type mismatch");
+            continue;
+        }
+        if (!have_compatible_directions(from->get_direction(), to->get_direction()))
+        {
+            reject("Direction mismatch");
+            continue;
+        }
+        std::size_t& n_from(n_connections_of(from));
+        std::size_t& n_to(n_connections_of(to));
+        if ((from->get_multiplicity() == "ONE") && (n_from > 0))
+        {
+            reject("Multiplicity of source interface is violated");
+            continue;
+        }
+        if ((to->get_multiplicity() == "ONE") && (n_to > 0))
+        {
+            reject("Multiplicity of target interface is violated");
+            continue;
+        }
+        n_from += 1;
+        n_to += 1;
+        accepted.insert({from.get(), to.get()});
+        to_be_added.push_back(index);
+    }
+
+    // NOTE: Our setters have been disabled and would throw. The base class functions scan all existing facts, so the facts and their inverse are appended in bulk instead.
+    for (const std::size_t index : to_be_added)
+    {
+        const auto& [from, to, properties] = connections[index];
+        from->append_peer("others", to, properties);
+        to->append_peer("from_others", from, properties);
+    }
+    // NOTE: The interfaces connected at once belong either all to models or all to modules
+    if (!to_be_added.empty())
+        count_model_modification_of(*std::get<0>(connections[to_be_added.front()]));
+    return rejected;
+}
+
 // This function disconnects this interface from all others
 void xtypes::Interface::disconnect()
 {
-    // Disconnect others from us first
-    std::vector<xtypes::Fact> others(this->get_facts("others"));
-    for (const auto &[o, _] : others)
+    // Disconnect others from us first (they store the reverse edge)
+    const XTypePtr self(shared_from_this());
+    for (const auto &[o, _] : this->get_facts("others"))
+    {
+        if (const InterfacePtr other = std::static_pointer_cast<Interface>(o.lock()))
+            other->remove_peer("from_others", self);
+    }
+    this->facts.at("others").clear();
+    this->peers_cleared("others");
+    count_model_modification_of(*this);
+}
+
+// Removes all connections of the given interfaces. The reverse edges are only removed at the interfaces which are not given.
+void xtypes::Interface::disconnect_all(const std::vector< InterfacePtr >& interfaces)
+{
+    std::unordered_set< const XType* > given;
+    for (const auto& interface : interfaces)
+        given.insert(interface.get());
+    for (const auto& interface : interfaces)
     {
-        const xtypes::XTypePtr other(o.lock());
-        std::vector<XTypePtr> to_remove;
-        // Gather info at other interfaces to be deleted
-        std::vector<xtypes::Fact> from_others(other->get_facts("from_others"));
-        for (const auto &[fo, _] : from_others)
+        for (const auto &[relation, inverse] : {std::make_pair("others", "from_others"), std::make_pair("from_others", "others")})
         {
-            const xtypes::XTypePtr from_other(fo.lock());
-            if (from_other->uuid() == this->uuid())
+            if (!interface->has_facts(relation))
+                continue;
+            for (const auto &[p, _] : interface->get_facts(relation))
             {
-                other->remove_fact("from_others", from_other);
+                const InterfacePtr peer(std::static_pointer_cast<Interface>(p.lock()));
+                if (peer && !given.count(peer.get()))
+                    peer->remove_peer(inverse, interface);
             }
         }
     }
-    this->facts.at("others").clear();
+    for (const auto& interface : interfaces)
+    {
+        for (const std::string relation : {"others", "from_others"})
+        {
+            if (!interface->has_facts(relation))
+                continue;
+            interface->facts.at(relation).clear();
+            interface->peers_cleared(relation);
+        }
+    }
+    if (!interfaces.empty())
+        count_model_modification_of(*interfaces.front());
 }
 
 // This function check connectability
@@ -151,18 +313,92 @@ bool xtypes::Interface::is_compatible_with(const InterfacePtr other)
         std::cout << "Interface.is_compatible_with(): Type mismatch" << std::endl;
         return false;
     }
-    if ((this->get_direction() == "OUTGOING" && other->get_direction() == "INCOMING") ||
-        (this->get_direction() == "INCOMING" && other->get_direction() == "OUTGOING")
-    )
-        return true;
-    else if (this->get_direction() == "BIDIRECTIONAL" && other->get_direction() == "BIDIRECTIONAL")
-        return true;
-    else if (this->get_direction() == "DIRECTION_NOT_SET" && other->get_direction() == "DIRECTION_NOT_SET")
+    if (have_compatible_directions(this->get_direction(), other->get_direction()))
         return true;
     std::cout << "Interface.is_compatible_with(): Direction mismatch" << std::endl;
     return false;
 }
 
+// The key of the compatibility index: (uuid of the InterfaceModel, direction)
+using CompatibilityKey = std::pair< std::size_t, std::string >;
+struct CompatibilityKeyHash
+{
+    std::size_t operator()(const CompatibilityKey& key) const
+    {
+        return key.first ^ (std::hash< std::string >()(key.second) + 0x9e3779b9 + (key.first << 6) + (key.first >> 2));
+    }
+};
+
+// Returns the direction an interface has to have to be connectable to an interface with the given direction
+static const std::string& compatible_direction(const std::string& direction)
+{
+    static const std::unordered_map< std::string, std::string > counterparts{
+        {"OUTGOING", "INCOMING"},
+        {"INCOMING", "OUTGOING"},
+        {"BIDIRECTIONAL", "BIDIRECTIONAL"},
+        {"DIRECTION_NOT_SET", "DIRECTION_NOT_SET"}
+    };
+    static const std::string none;
+    const auto it = counterparts.find(direction);
+    return (it != counterparts.end()) ? it->second : none;
+}
+
+// Returns true if an interface cannot take any further connections (see is_connectable_to())
+static bool is_saturated(const Interface& interface)
+{
+    return interface.get_multiplicity() == "ONE" &&
+        ((interface.has_facts("others") && interface.get_facts("others").size() > 0) ||
+         (interface.has_facts("from_others") && interface.get_facts("from_others").size() > 0));
+}
+
+// Returns the type of an interface or nullptr if it has none
+static InterfaceModelPtr type_of(Interface& interface)
+{
+    if (!interface.has_facts("model") || interface.get_facts("model").empty())
+        return nullptr;
+    return interface.get_type();
+}
+
+// Finds all pairs of connectable interfaces by looking up the counterparts of the from interfaces in a hash index of the to interfaces
+std::map< InterfacePtr, std::vector< InterfacePtr > > xtypes::Interface::find_connectable_pairs(const std::vector< InterfacePtr >& from, const std::vector< InterfacePtr >& to)
+{
+    std::map< InterfacePtr, std::vector< InterfacePtr > > result;
+    // Index the to interfaces which can take further connections by (type uuid, direction)
+    // NOTE: The uuid of the type is derived only once per interface here. Interfaces without a type cannot be connected at all.
+    std::unordered_map< CompatibilityKey, std::vector< InterfacePtr >, CompatibilityKeyHash > index;
+    for (const auto& interface : to)
+    {
+        if (!interface || is_saturated(*interface))
+            continue;
+        const InterfaceModelPtr type(type_of(*interface));
+        if (!type)
+            continue;
+        index[{type->uuid(), interface->get_direction()}].push_back(interface);
+    }
+    if (index.empty())
+        return result;
+    for (const auto& interface : from)
+    {
+        if (!interface || is_saturated(*interface))
+            continue;
+        const InterfaceModelPtr type(type_of(*interface));
+        if (!type)
+            continue;
+        const auto it = index.find({type->uuid(), compatible_direction(interface->get_direction())});
+        if (it == index.end())
+            continue;
+        std::vector< InterfacePtr > matches;
+        matches.reserve(it->second.size());
+        // NOTE: An interface is never connectable to itself (e.g. a BIDIRECTIONAL one which is part of both lists)
+        for (const auto& other : it->second)
+            if (other != interface)
+                matches.push_back(other);
+        if (!matches.empty())
+            result.emplace(interface, std::move(matches));
+    }
+    return result;
+}
+
 // This function returns true if both interfaces share the same type/InterfaceModel
 bool xtypes::Interface::has_same_type(const InterfacePtr other)
 {
@@ -211,6 +447,7 @@ DynamicInterfacePtr xtypes::Interface::get_dynamic_interface()
 void xtypes::Interface::realizes(const InterfacePtr interface_of_abstract_component_model)
 {
     this->add_interfaces_of_abstracts(interface_of_abstract_component_model);
+    count_model_modification_of(*this);
 }
 
 // Overrides for setters of properties
@@ -241,6 +478,7 @@ void xtypes::Interface::add_parent(xtypes::ComponentCPtr xtype, const nl::json&
     {
         throw std::invalid_argument("xtypes::Interface::add_parent(): Already has a parent");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_Interface::add_parent(xtype, props);
 }
@@ -253,6 +491,7 @@ void xtypes::Interface::add_parent(xtypes::ComponentModelCPtr xtype, const nl::j
     {
         throw std::invalid_argument("xtypes::Interface::add_parent(): Already has a parent");
     }
+    count_model_modification();
     // Finally call the overridden method
     this->_Interface::add_parent(xtype, props);
 }
@@ -287,6 +526,7 @@ void xtypes::Interface::unrealize()
     {
         this->facts.at("interfaces_of_abstracts").clear();
     }
+    count_model_modification_of(*this);
 }
 
 // This function returns true if this interface has already realized an abstract interface
@@ -300,3 +540,125 @@ bool xtypes::Interface::has_realization(const InterfacePtr other)
     }
     return false;
 }
+
+void xtypes::Interface::remove_fact(const std::string& relation, XTypeCPtr target)
+{
+    // NOTE: The facts of the connection relations are removed by remove_peer(), which keeps the index in sync
+    if ((relation == "others") || (relation == "from_others"))
+        this->remove_peer(relation, std::const_pointer_cast< XType >(target));
+    else
+        this->_Interface::remove_fact(relation, target);
+    count_model_modification_of(*this);
+}
+
+// Returns true if a fact points to the peer (by identity)
+static bool points_to(const Fact& fact, const XTypePtr& peer)
+{
+    return !fact.target.owner_before(peer) && !peer.owner_before(fact.target);
+}
+
+xtypes::Interface::PeerIndex& xtypes::Interface::synced_index_of(const std::string& relation)
+{
+    PeerIndex& index(relation == "others" ? m_others_index : m_from_others_index);
+    static const std::vector< Fact > no_facts;
+    const std::vector< Fact >& peers(this->has_facts(relation) ? this->get_facts(relation) : no_facts);
+    if ((index.indexed == index.modifications) && (index.positions.size() == peers.size()))
+    {
+        // NOTE: Facts added through the XType interface are appended, so they show up as an unknown last fact
+        if (peers.empty())
+            return index;
+        const auto& last(index.positions.find(peers.back().target));
+        if ((last != index.positions.end()) && (last->second == peers.size() - 1))
+            return index;
+    }
+    index.positions.clear();
+    for (std::size_t position = 0; position < peers.size(); ++position)
+        index.positions.emplace(peers[position].target, position);
+    index.indexed = index.modifications;
+    return index;
+}
+
+bool xtypes::Interface::has_peer(const std::string& relation, const XTypePtr& peer)
+{
+    PeerIndex& index(this->synced_index_of(relation));
+    const auto& it(index.positions.find(peer));
+    if (it == index.positions.end())
+        return false;
+    // NOTE: The fact may have been removed through the XType interface, so the hit has to be confirmed (a freshly built index always confirms it)
+    const std::vector< Fact >& peers(this->get_facts(relation));
+    if ((it->second < peers.size()) && points_to(peers[it->second], peer))
+        return true;
+    index.indexed = PeerIndex::npos;
+    return this->has_peer(relation, peer);
+}
+
+void xtypes::Interface::peer_added(const std::string& relation, const XTypePtr& peer)
+{
+    PeerIndex& index(relation == "others" ? m_others_index : m_from_others_index);
+    const bool in_sync(index.indexed == index.modifications);
+    index.modifications += 1;
+    if (!in_sync)
+        return;
+    // NOTE: Re-adding a peer only updates the edge properties. Otherwise its fact has been appended.
+    if (!index.positions.count(peer))
+    {
+        const std::vector< Fact >& peers(this->get_facts(relation));
+        if (peers.empty() || !points_to(peers.back(), peer))
+            return;
+        index.positions.emplace(peer, peers.size() - 1);
+    }
+    index.indexed = index.modifications;
+}
+
+void xtypes::Interface::append_peer(const std::string& relation, const XTypePtr& peer, const nl::json& properties)
+{
+    std::vector< Fact >& peers(this->facts[relation]);
+    // NOTE: Like add_fact(), an existing fact only gets its edge properties updated
+    if (this->has_peer(relation, peer))
+        peers[this->synced_index_of(relation).positions.find(peer)->second].edge_properties = properties;
+    else
+        peers.push_back(Fact{peer, properties});
+    this->peer_added(relation, peer);
+}
+
+void xtypes::Interface::remove_peer(const std::string& relation, const XTypePtr& peer)
+{
+    if (!this->has_facts(relation) || !this->has_peer(relation, peer))
+        return;
+    // NOTE: There is at most one fact per peer and has_peer() has confirmed its position.
+    // The last fact takes the place of the removed one, so no other position changes.
+    auto& peers(this->facts.at(relation));
+    const std::size_t position(this->synced_index_of(relation).positions.find(peer)->second);
+    if (position + 1 < peers.size())
+        peers[position] = std::move(peers.back());
+    peers.pop_back();
+    this->peer_removed(relation, peer, position);
+}
+
+void xtypes::Interface::peer_removed(const std::string& relation, const XTypePtr& peer, const std::size_t position)
+{
+    PeerIndex& index(relation == "others" ? m_others_index : m_from_others_index);
+    const bool in_sync(index.indexed == index.modifications);
+    index.modifications += 1;
+    if (!in_sync)
+        return;
+    index.positions.erase(peer);
+    // The last fact has been moved to the position of the removed one
+    const std::vector< Fact >& peers(this->get_facts(relation));
+    if (position < peers.size())
+    {
+        const auto& moved(index.positions.find(peers[position].target));
+        if (moved == index.positions.end())
+            return;
+        moved->second = position;
+    }
+    index.indexed = index.modifications;
+}
+
+void xtypes::Interface::peers_cleared(const std::string& relation)
+{
+    PeerIndex& index(relation == "others" ? m_others_index : m_from_others_index);
+    index.positions.clear();
+    index.modifications += 1;
+    index.indexed = index.modifications;
+}
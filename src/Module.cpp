@@ -2,8 +2,16 @@
 
 // Including used XType classes
 #include "ComponentModel.hpp"
+#include "Component.hpp"
+#include "Interface.hpp"
+#include "InterfaceModel.hpp"
+#include "BuildPlan.hpp"
 
 #include <inja/inja.hpp>
+#include <atomic>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 using namespace xtypes;
 
@@ -16,16 +24,57 @@ xtypes::Module::Module(const std::string& classname) : _Module(classname)
 // Static identifier
 const std::string xtypes::Module::classname = "xtypes::Module";
 
+// The inputs of _Module::uri() are the whole, the model and the name
+xtypes::CachedUri::Inputs xtypes::Module::uri_inputs() const
+{
+    CachedUri::Inputs inputs;
+    // NOTE: This is called on every access of the uri, so the facts are looked up only once and the name is not copied
+    const auto whole_facts(this->facts.find("whole"));
+    if ((whole_facts != this->facts.end()) && !whole_facts->second.empty())
+    {
+        inputs.parent = &whole_facts->second[0].target;
+        XTypePtr whole(inputs.parent->lock());
+        if (const Module* module = dynamic_cast<const Module*>(whole.get()))
+            inputs.parent_version = module->uri_version();
+        else if (whole)
+            inputs.parent_uri = whole->uri();
+    }
+    const auto model_facts(this->facts.find("model"));
+    if ((model_facts != this->facts.end()) && !model_facts->second.empty())
+    {
+        inputs.model = &model_facts->second[0].target;
+        // NOTE: The uri of the model is built from these properties, so it does not have to be built here
+        if (XTypePtr model = inputs.model->lock())
+            inputs.model_properties = {CachedUri::property_of(*model, "domain"), CachedUri::property_of(*model, "name"), CachedUri::property_of(*model, "version")};
+    }
+    inputs.name = &this->properties.at("name");
+    return inputs;
+}
+
+std::string xtypes::Module::uri() const
+{
+    return m_cached_uri.get(this->uri_inputs(), [this]() { return this->_Module::uri(); });
+}
+
+std::uint64_t xtypes::Module::uri_version() const
+{
+    return m_cached_uri.version(this->uri_inputs(), [this]() { return this->_Module::uri(); });
+}
+
 // Method implementations
 // Returns true if this Module hasn't any parts
 bool xtypes::Module::is_atomic()
 {
+    // NOTE: Only modules with parts get deferred
+    if (m_lazy_build)
+        return false;
     return (this->get_facts("parts").size() == 0);
 }
 
 // Search and return a part of the module with the given name
 ModulePtr xtypes::Module::get_part(const std::string& name)
 {
+    this->materialize(false);
     for (const auto &[p,_] : this->get_facts("parts"))
     {
         const ModulePtr part(std::static_pointer_cast<Module>(p.lock()));
@@ -66,6 +115,7 @@ void xtypes::Module::configure(const nl::json& config_overrides)
     }
     // Update our configuration
     this->set_configuration(current_config);
+    this->materialize(false);
     // Call configure with the (possibly updates config_overrides) on all our submodules
     for (const auto& [p, _] : this->get_facts("parts"))
     {
@@ -83,6 +133,7 @@ void xtypes::Module::apply_global_variables(const nl::json& global_variables)
         return;
     std::string configuration = inja::render(this->get_configuration().dump(), vars);
     this->set_configuration(nl::json::parse(configuration));
+    this->materialize(false);
     for (const auto& [p, _] : this->get_facts("parts"))
     {
         const xtypes::ModulePtr part(std::static_pointer_cast<Module>(p.lock()));
@@ -108,6 +159,403 @@ nl::json xtypes::Module::get_global_variables(const nl::json& global_variables)
     return merged_vars;
 }
 
+// Removes a submodule and its whole subtree from the module hierarchy
+static void remove_submodule(const ModulePtr& whole, const ModulePtr& submodule)
+{
+    std::vector< ModulePtr > to_visit{submodule};
+    std::vector< InterfacePtr > interfaces;
+    while (to_visit.size() > 0)
+    {
+        const ModulePtr module(to_visit.back());
+        to_visit.pop_back();
+        for (const auto &[i, _] : module->get_facts("interfaces"))
+            interfaces.push_back(std::static_pointer_cast<Interface>(i.lock()));
+        for (const auto &[p, _] : module->get_facts("parts"))
+            to_visit.push_back(std::static_pointer_cast<Module>(p.lock()));
+    }
+    Interface::disconnect_all(interfaces);
+    whole->remove_fact("parts", submodule);
+    submodule->remove_fact("whole", whole);
+}
+
+// Matches the interfaces of a module against the interfaces of its model
+// Interfaces with the same name and type are kept, missing ones are created and obsolete ones are removed.
+// Returns the interfaces of the module in the order of the model interfaces.
+static std::vector< std::pair< InterfacePtr, InterfaceModelPtr > > update_interfaces(XTypeRegistryPtr reg, const ModulePtr& module, const ComponentModelPtr& model)
+{
+    module->set_unknown_fact_empty("interfaces");
+    std::multimap< std::string, InterfacePtr > existing;
+    for (const auto &[i, _] : module->get_facts("interfaces"))
+    {
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        existing.emplace(interface->get_name(), interface);
+    }
+    std::vector< std::pair< InterfacePtr, InterfaceModelPtr > > result;
+    for (const auto &[i, _] : model->get_facts("interfaces"))
+    {
+        const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+        const InterfaceModelPtr ifmodel(interface->get_type());
+        InterfacePtr match{nullptr};
+        const auto& range(existing.equal_range(interface->get_name()));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->get_type()->uuid() != ifmodel->uuid())
+                continue;
+            match = it->second;
+            existing.erase(it);
+            break;
+        }
+        if (match)
+        {
+            // Direction, multiplicity etc. might have changed
+            match->set_properties(interface->get_properties());
+        } else {
+            match = instantiate_locked<Interface>(reg);
+            match->set_all_unknown_facts_empty();
+            match->set_properties(interface->get_properties());
+            module->has(match);
+            match->instance_of(ifmodel);
+        }
+        result.push_back({match, ifmodel});
+    }
+    // Remove the interfaces which are not part of the model anymore
+    for (const auto &[_, obsolete] : existing)
+    {
+        Interface::disconnect_all({obsolete});
+        module->remove_fact("interfaces", obsolete);
+        obsolete->remove_fact("parent", module);
+    }
+    return result;
+}
+
+// This function updates this Module to match the (possibly edited) model.
+void xtypes::Module::rebuild_from(const ComponentModelPtr model, const std::function< ComponentModelPtr(const ComponentModelPtr&, const std::vector<ComponentModelPtr>&) >& select_implementation)
+{
+    XTypeRegistryPtr reg = this->registry.lock();
+    if (!reg)
+    {
+        throw std::invalid_argument("Module::rebuild_from(): No registry");
+    }
+
+    // Resolve abstract models the same way ComponentModel::build() does
+    ComponentModelPtr impl(model);
+    if (impl->get_abstract())
+    {
+        const std::vector< ComponentModelPtr >& implementations(impl->get_implementations());
+        if (implementations.size() < 1)
+        {
+            throw std::invalid_argument("Module::rebuild_from(): " + impl->uri() + " is abstract but has no implementations");
+        }
+        if ((implementations.size() > 1) && !select_implementation)
+        {
+            throw std::invalid_argument("Module::rebuild_from(): " + impl->uri() + " is abstract and has multiple implementations but callback func is missing");
+        }
+        impl = (implementations.size() > 1) ? select_implementation(impl, implementations) : implementations[0];
+        return this->rebuild_from(impl, select_implementation);
+    }
+    // The diff below needs the complete module tree
+    this->materialize(true);
+    const std::shared_ptr< const BuildPlan > plan(compile_build_plan(impl, select_implementation));
+    const std::vector< BuildNode >& nodes(plan->nodes);
+    const ModulePtr self(std::static_pointer_cast<Module>(shared_from_this()));
+
+    // Update the toplvl module
+    // NOTE: The configuration of this module is kept
+    const ComponentModelPtr current_model((this->has_facts("model") && (this->get_facts("model").size() > 0)) ? this->get_type() : nullptr);
+    if (!current_model || (current_model->uuid() != impl->uuid()))
+    {
+        if (current_model)
+            this->remove_fact("model", current_model);
+        this->instance_of(impl);
+    }
+    BuiltNode toplvl;
+    toplvl.module = self;
+    toplvl.interfaces = update_interfaces(reg, self, impl);
+
+    // Match the submodules against the nodes of the plan
+    // A submodule matches if it belongs to the matched parent, has the name of the part and has been built from the same model
+    std::vector< BuiltNode > built(nodes.size());
+    std::map< ModulePtr, std::multimap< std::string, ModulePtr > > unmatched;
+    auto unmatched_parts_of = [&](const ModulePtr& whole) -> std::multimap< std::string, ModulePtr >&
+    {
+        auto it = unmatched.find(whole);
+        if (it == unmatched.end())
+        {
+            it = unmatched.emplace(whole, std::multimap< std::string, ModulePtr >()).first;
+            whole->set_unknown_fact_empty("parts");
+            for (const auto &[p, _] : whole->get_facts("parts"))
+            {
+                const ModulePtr part(std::static_pointer_cast<Module>(p.lock()));
+                it->second.emplace(part->get_name(), part);
+            }
+        }
+        return it->second;
+    };
+    for (std::size_t index = 0; index < nodes.size(); ++index)
+    {
+        const BuildNode& node(nodes[index]);
+        const ModulePtr& whole(node.parent == BuildNode::npos ? self : built[node.parent].module);
+        std::multimap< std::string, ModulePtr >& candidates(unmatched_parts_of(whole));
+        const auto& range(candidates.equal_range(node.part->get_name()));
+        ModulePtr match{nullptr};
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const ComponentModelPtr candidate_model(it->second->get_type());
+            if (!candidate_model || (candidate_model->uuid() != node.model->uuid()))
+                continue;
+            match = it->second;
+            candidates.erase(it);
+            break;
+        }
+        if (match)
+        {
+            // Keep the submodule (and its configuration) but update everything else
+            match->set_alias(node.part->get_alias());
+            built[index].module = match;
+            built[index].interfaces = update_interfaces(reg, match, node.model);
+        } else {
+            materialize_build_node(reg, node, built[index]);
+            built[index].module->instance_of(node.model);
+            built[index].module->part_of(whole);
+            for (const auto &[clone, ifmodel] : built[index].interfaces)
+                clone->instance_of(ifmodel);
+        }
+    }
+
+    // Remove all submodules which have not been matched
+    for (const auto &[whole, obsolete] : unmatched)
+        for (const auto &[_, submodule] : obsolete)
+            remove_submodule(whole, submodule);
+
+    auto interface_of = [&](const BuildInterfaceRef& ref) -> const InterfacePtr&
+    {
+        return ((ref.first == BuildNode::npos) ? toplvl : built[ref.first]).interfaces[ref.second].first;
+    };
+
+    // Rewire aliases and connections
+    // At first, we collect what should be there
+    std::map< InterfacePtr, std::set< InterfacePtr > > wanted_aliases;
+    for (const auto &[alias, original] : plan->aliases)
+        wanted_aliases[interface_of(alias)].insert(interface_of(original));
+    std::map< InterfacePtr, std::map< InterfacePtr, nl::json > > wanted_connections;
+    for (const auto &[from, to, conn_props] : plan->connections)
+        wanted_connections[interface_of(from)].emplace(interface_of(to), conn_props);
+
+    // Then we remove everything which should not be there (anymore)
+    std::vector< InterfacePtr > interfaces;
+    for (const auto &[interface, _] : toplvl.interfaces)
+        interfaces.push_back(interface);
+    for (const auto& b : built)
+        for (const auto &[interface, _] : b.interfaces)
+            interfaces.push_back(interface);
+    for (const InterfacePtr& interface : interfaces)
+    {
+        const std::set< InterfacePtr >& originals(wanted_aliases[interface]);
+        const std::vector<xtypes::Fact> current_originals(interface->get_facts("original"));
+        for (const auto &[o, _] : current_originals)
+        {
+            const InterfacePtr original(std::static_pointer_cast<Interface>(o.lock()));
+            if (originals.count(original) < 1)
+                interface->remove_fact("original", original);
+        }
+        const std::map< InterfacePtr, nl::json >& others(wanted_connections[interface]);
+        const std::vector<xtypes::Fact> current_others(interface->get_facts("others"));
+        for (const auto &[o, conn_props] : current_others)
+        {
+            const InterfacePtr other(std::static_pointer_cast<Interface>(o.lock()));
+            const auto& it(others.find(other));
+            if ((it != others.end()) && (it->second == conn_props))
+                continue;
+            interface->remove_fact("others", other);
+            other->remove_fact("from_others", interface);
+        }
+    }
+
+    // Finally, we add what is missing
+    for (const auto &[alias, original] : plan->aliases)
+    {
+        const InterfacePtr& alias_interface(interface_of(alias));
+        const InterfacePtr& original_interface(interface_of(original));
+        bool exists = false;
+        for (const auto &[o, _] : alias_interface->get_facts("original"))
+            exists = exists || (o.lock() == original_interface);
+        if (!exists)
+            alias_interface->alias_of(original_interface);
+    }
+    // NOTE: connect_all() keeps the connections which exist already
+    std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > > connections;
+    connections.reserve(plan->connections.size());
+    for (const auto &[from, to, conn_props] : plan->connections)
+        connections.emplace_back(interface_of(from), interface_of(to), conn_props);
+    warn_about_rejected_connections(Interface::connect_all(connections));
+}
+
+// This function creates all pending parts of a lazily built Module (recursively if deep is true)
+void xtypes::Module::materialize(const bool& deep)
+{
+    if (m_lazy_build)
+    {
+        XTypeRegistryPtr reg = this->registry.lock();
+        if (!reg)
+        {
+            throw std::invalid_argument("Module::materialize(): No registry");
+        }
+        // NOTE: We reset our state first, so we do not get materialized twice
+        const std::shared_ptr< LazyBuild > lazy(m_lazy_build);
+        const std::size_t slot(lazy->slot(m_lazy_node));
+        m_lazy_build = nullptr;
+        m_lazy_node = BuildNode::npos;
+
+        // Create our parts exactly like ComponentModel::build() does, but defer their parts
+        const BuildPlan& plan(*lazy->plan);
+        const ModulePtr self(std::static_pointer_cast<Module>(shared_from_this()));
+        for (const std::size_t child : lazy->children[slot])
+        {
+            BuiltNode built;
+            materialize_build_node(reg, plan.nodes[child], built);
+            built.module->instance_of(plan.nodes[child].model);
+            built.module->part_of(self);
+            for (const auto &[clone, ifmodel] : built.interfaces)
+            {
+                clone->instance_of(ifmodel);
+                lazy->interfaces[child].push_back(clone);
+            }
+            if (lazy->children[child].size() > 0)
+                built.module->defer_parts(lazy, child);
+        }
+
+        // Resolve the aliases of our interfaces and the connections between our parts
+        auto interface_of = [&](const BuildInterfaceRef& ref) -> const InterfacePtr&
+        {
+            return lazy->interfaces[lazy->slot(ref.first)][ref.second];
+        };
+        for (const std::size_t index : lazy->aliases[slot])
+            interface_of(plan.aliases[index].first)->alias_of(interface_of(plan.aliases[index].second));
+        std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > > connections;
+        for (const std::size_t index : lazy->connections[slot])
+        {
+            const auto &[from, to, conn_props] = plan.connections[index];
+            connections.emplace_back(interface_of(from), interface_of(to), conn_props);
+        }
+        warn_about_rejected_connections(Interface::connect_all(connections));
+        // Our own interfaces are not needed anymore
+        lazy->interfaces[slot].clear();
+    }
+    if (!deep)
+        return;
+    for (const auto& [p, _] : this->get_facts("parts"))
+    {
+        const xtypes::ModulePtr part(std::static_pointer_cast<Module>(p.lock()));
+        part->materialize(deep);
+    }
+}
+
+// This function deep-copies this Module tree (including interfaces, connections and aliases) into a new toplvl Module with the given name
+ModulePtr xtypes::Module::clone(const std::string& new_name)
+{
+    XTypeRegistryPtr reg = this->registry.lock();
+    if (!reg)
+    {
+        throw std::invalid_argument("Module::clone(): No registry");
+    }
+    // We need the complete tree
+    this->materialize(true);
+
+    // Collect the tree in BFS order
+    std::vector< ModulePtr > modules{std::static_pointer_cast<Module>(shared_from_this())};
+    std::size_t n_interfaces = 0;
+    for (std::size_t index = 0; index < modules.size(); ++index)
+    {
+        const ModulePtr module(modules[index]);
+        module->set_unknown_fact_empty("interfaces");
+        module->set_unknown_fact_empty("parts");
+        n_interfaces += module->get_facts("interfaces").size();
+        for (const auto &[p, _] : module->get_facts("parts"))
+            modules.push_back(std::static_pointer_cast<Module>(p.lock()));
+    }
+
+    // Allocate all copies at once
+    std::vector< ModulePtr > module_copies;
+    std::vector< InterfacePtr > interface_copies;
+    module_copies.reserve(modules.size());
+    interface_copies.reserve(n_interfaces);
+    {
+        std::lock_guard< std::mutex > lock(registry_mutex());
+        for (std::size_t index = 0; index < modules.size(); ++index)
+            module_copies.push_back(reg->instantiate<Module>());
+        for (std::size_t index = 0; index < n_interfaces; ++index)
+            interface_copies.push_back(reg->instantiate<Interface>());
+    }
+
+    // Copy the modules and their interfaces
+    std::unordered_map< const XType*, ModulePtr > module2copy;
+    std::unordered_map< const XType*, InterfacePtr > interface2copy;
+    std::vector< InterfacePtr > interfaces;
+    module2copy.reserve(modules.size());
+    interface2copy.reserve(n_interfaces);
+    interfaces.reserve(n_interfaces);
+    std::size_t next_interface = 0;
+    for (std::size_t index = 0; index < modules.size(); ++index)
+    {
+        const ModulePtr& module(modules[index]);
+        const ModulePtr& copy(module_copies[index]);
+        module2copy[module.get()] = copy;
+        copy->set_properties(module->get_properties(), false);
+        copy->set_unknown_fact_empty("interfaces");
+        copy->set_unknown_fact_empty("parts");
+        if (index == 0)
+        {
+            copy->set_name(new_name);
+            copy->set_unknown_fact_empty("whole");
+        } else {
+            copy->part_of(module2copy.at(module->get_facts("whole")[0].target.lock().get()));
+        }
+        copy->instance_of(module->get_type());
+        for (const auto &[i, _] : module->get_facts("interfaces"))
+        {
+            const InterfacePtr interface(std::static_pointer_cast<Interface>(i.lock()));
+            const InterfacePtr& interface_copy(interface_copies[next_interface++]);
+            interface2copy[interface.get()] = interface_copy;
+            interfaces.push_back(interface);
+            interface_copy->set_all_unknown_facts_empty();
+            interface_copy->set_properties(interface->get_properties());
+            copy->has(interface_copy);
+            interface_copy->instance_of(interface->get_type());
+        }
+    }
+
+    // Copy the aliases and connections inside the tree
+    // NOTE: The interfaces are visited in the (BFS) order of their copies, so the facts of a clone are in the same order every time. Connections to interfaces outside of the tree are not copied.
+    std::vector< std::tuple< InterfacePtr, InterfacePtr, nl::json > > connections;
+    for (std::size_t index = 0; index < interfaces.size(); ++index)
+    {
+        const InterfacePtr& interface(interfaces[index]);
+        const InterfacePtr& interface_copy(interface_copies[index]);
+        for (const auto &[o, _] : interface->get_facts("original"))
+        {
+            const auto& it(interface2copy.find(o.lock().get()));
+            if (it != interface2copy.end())
+                interface_copy->alias_of(it->second);
+        }
+        for (const auto &[o, conn_props] : interface->get_facts("others"))
+        {
+            const auto& it(interface2copy.find(o.lock().get()));
+            if (it != interface2copy.end())
+                connections.emplace_back(interface_copy, it->second, conn_props);
+        }
+    }
+    // NOTE: connect_all() appends the facts without scanning the existing ones (the connections have been checked before, so none should be rejected)
+    warn_about_rejected_connections(Interface::connect_all(connections));
+    return module_copies[0];
+}
+
+// Marks the parts of this module as pending until they are accessed
+void xtypes::Module::defer_parts(const std::shared_ptr< LazyBuild >& lazy_build, const std::size_t node)
+{
+    m_lazy_build = lazy_build;
+    m_lazy_node = node;
+}
+
 // Overrides for setters of properties
 
 // Overrides for relation setters
@@ -124,3 +572,71 @@ void xtypes::Module::add_whole(xtypes::ModuleCPtr xtype, const nl::json& props)
     // Finally call the overridden method
     this->_Module::add_whole(xtype, props);
 }
+
+// Versions identify uris among all caches, so a cache which is replaced by another one at the same address is not mistaken for the old one
+static std::atomic< std::uint64_t > next_uri_version(1);
+
+// Xtypes are compared by identity (which is not reused as long as a weak_ptr is held)
+static bool same_xtype(const std::weak_ptr< xtypes::XType >* a, const std::weak_ptr< xtypes::XType >& b)
+{
+    if (!a)
+        return !b.owner_before(std::weak_ptr< xtypes::XType >()) && !std::weak_ptr< xtypes::XType >().owner_before(b);
+    return !a->owner_before(b) && !b.owner_before(*a);
+}
+
+// Returns the value of a property input (null if the uri is not built from it)
+static const nl::json& value_of(const nl::json* property)
+{
+    static const nl::json none;
+    return property ? *property : none;
+}
+
+// Gives access to the properties of any xtype
+struct PropertyAccess : public xtypes::XType
+{
+    static const std::map< std::string, nl::json >& of(const xtypes::XType& xtype)
+    {
+        return xtype.*(&PropertyAccess::properties);
+    }
+};
+
+const nl::json* xtypes::CachedUri::property_of(const XType& xtype, const std::string& name)
+{
+    const auto& properties(PropertyAccess::of(xtype));
+    const auto& it(properties.find(name));
+    return (it != properties.end()) ? &it->second : nullptr;
+}
+
+std::string xtypes::CachedUri::get(const Inputs& inputs, const std::function< std::string() >& build) const
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    this->update(inputs, build);
+    return m_uri;
+}
+
+std::uint64_t xtypes::CachedUri::version(const Inputs& inputs, const std::function< std::string() >& build) const
+{
+    std::lock_guard< std::mutex > lock(m_mutex);
+    this->update(inputs, build);
+    return m_version;
+}
+
+void xtypes::CachedUri::update(const Inputs& inputs, const std::function< std::string() >& build) const
+{
+    if (m_valid && same_xtype(inputs.parent, m_parent) && (m_parent_version == inputs.parent_version) && (m_parent_uri == inputs.parent_uri)
+        && same_xtype(inputs.model, m_model) && (m_model_properties[0] == value_of(inputs.model_properties[0])) && (m_model_properties[1] == value_of(inputs.model_properties[1]))
+        && (m_model_properties[2] == value_of(inputs.model_properties[2])) && (m_name == value_of(inputs.name)) && (m_direction == value_of(inputs.direction)))
+        return;
+    // NOTE: Building the uri locks the caches of the parents, but never the one of this xtype
+    m_uri = build();
+    m_parent = inputs.parent ? *inputs.parent : std::weak_ptr< XType >();
+    m_parent_version = inputs.parent_version;
+    m_parent_uri = inputs.parent_uri;
+    m_model = inputs.model ? *inputs.model : std::weak_ptr< XType >();
+    for (std::size_t i = 0; i < m_model_properties.size(); ++i)
+        m_model_properties[i] = value_of(inputs.model_properties[i]);
+    m_name = value_of(inputs.name);
+    m_direction = value_of(inputs.direction);
+    m_version = next_uri_version++;
+    m_valid = true;
+}
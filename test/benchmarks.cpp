@@ -0,0 +1,458 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include <iostream>
+#include <filesystem>
+// Include XTypes
+#include <xtypes_generator/utils.hpp>
+
+#include "ComponentModel.hpp"
+#include "InterfaceModel.hpp"
+#include "Interface.hpp"
+#include "Component.hpp"
+#include "Module.hpp"
+#include "ProjectRegistry.hpp"
+#include "BasicModelStream.hpp"
+
+using namespace xtypes;
+namespace fs = std::filesystem;
+
+// Creates a composite model with a chain of n_parts leaf parts.
+// Every part is connected to its successor and the first input as well as the last output are exported by the composite.
+static ComponentModelPtr create_chain_model(XTypeRegistryPtr pr, const std::size_t n_parts)
+{
+    InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+    im->set_all_unknown_facts_empty();
+    im->set_properties({{"name", "float"}, {"domain", "SOFTWARE"}});
+
+    ComponentModelPtr leaf = pr->instantiate<ComponentModel>();
+    leaf->set_properties({{"name", "Leaf"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    leaf->set_all_unknown_facts_empty();
+    im->instantiate(leaf, "in", "INCOMING", "ONE", true);
+    im->instantiate(leaf, "out", "OUTGOING", "N", true);
+
+    ComponentModelPtr chain = pr->instantiate<ComponentModel>();
+    chain->set_properties({{"name", "Chain" + std::to_string(n_parts)}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    chain->set_all_unknown_facts_empty();
+
+    InterfacePtr previous_out{nullptr};
+    for (std::size_t i = 0; i < n_parts; ++i)
+    {
+        ComponentPtr part = leaf->instantiate(chain, "part" + std::to_string(i), true);
+        InterfacePtr in = part->get_interface("in");
+        InterfacePtr out = part->get_interface("out");
+        if (previous_out)
+            previous_out->connected_to(in, {{"name", "conn" + std::to_string(i)}});
+        else
+            chain->export_inner_interface(in, true);
+        previous_out = out;
+    }
+    chain->export_inner_interface(previous_out, true);
+    return chain;
+}
+
+TEST_CASE("Benchmark ComponentModel::build", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    for (const std::size_t n_parts : {100, 200, 400, 800, 1600, 3200})
+    {
+        ComponentModelPtr chain = create_chain_model(pr, n_parts);
+        BENCHMARK("build chain with " + std::to_string(n_parts) + " parts")
+        {
+            return chain->build("chain");
+        };
+        chain->build("chain", nullptr, {{"cache_plan", true}});
+        BENCHMARK("build chain with " + std::to_string(n_parts) + " parts from cached plan")
+        {
+            return chain->build("chain", nullptr, {{"cache_plan", true}});
+        };
+        ComponentModel::forget_build_plans();
+        pr->clear();
+    }
+}
+
+TEST_CASE("Benchmark persistent build cache", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    const std::string cache_dir((fs::temp_directory_path() / "xtypes_build_cache_benchmark").string());
+    fs::remove_all(cache_dir);
+    ComponentModelPtr chain = create_chain_model(pr, 800);
+    BENCHMARK("build chain with 800 parts")
+    {
+        return chain->build("chain");
+    };
+    chain->build("chain", nullptr, {{"cache_dir", cache_dir}});
+    BENCHMARK("load chain with 800 parts from persistent build cache")
+    {
+        return chain->build("chain", nullptr, {{"cache_dir", cache_dir}});
+    };
+    fs::remove_all(cache_dir);
+}
+
+TEST_CASE("Benchmark parallel ComponentModel::build", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    // A wide assembly: many toplvl parts, each of them being a chain of parts
+    ComponentModelPtr chain = create_chain_model(pr, 50);
+    ComponentModelPtr assembly = pr->instantiate<ComponentModel>();
+    assembly->set_properties({{"name", "Assembly"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    assembly->set_all_unknown_facts_empty();
+    for (std::size_t i = 0; i < 64; ++i)
+        chain->instantiate(assembly, "chain" + std::to_string(i), true);
+
+    BENCHMARK("build 64 x 50 parts serially")
+    {
+        return assembly->build("assembly");
+    };
+    BENCHMARK("build 64 x 50 parts in parallel")
+    {
+        return assembly->build("assembly", nullptr, {{"parallel", true}});
+    };
+}
+
+TEST_CASE("Benchmark lazy ComponentModel::build", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    ComponentModelPtr chain = create_chain_model(pr, 50);
+    ComponentModelPtr assembly = pr->instantiate<ComponentModel>();
+    assembly->set_properties({{"name", "Assembly"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    assembly->set_all_unknown_facts_empty();
+    for (std::size_t i = 0; i < 64; ++i)
+        chain->instantiate(assembly, "chain" + std::to_string(i), true);
+
+    BENCHMARK("build 64 x 50 parts and access one of them")
+    {
+        return assembly->build("assembly")->get_part("chain0")->get_part("part0");
+    };
+    BENCHMARK("build 64 x 50 parts lazily and access one of them")
+    {
+        return assembly->build("assembly", nullptr, {{"lazy", true}})->get_part("chain0")->get_part("part0");
+    };
+}
+
+TEST_CASE("Benchmark Module::clone", "[!benchmark][Module]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    ComponentModelPtr chain = create_chain_model(pr, 50);
+    ComponentModelPtr assembly = pr->instantiate<ComponentModel>();
+    assembly->set_properties({{"name", "Assembly"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    assembly->set_all_unknown_facts_empty();
+    for (std::size_t i = 0; i < 16; ++i)
+        chain->instantiate(assembly, "chain" + std::to_string(i), true);
+    ModulePtr robot = assembly->build("robot");
+
+    BENCHMARK("build 16 x 50 parts")
+    {
+        return assembly->build("robot1");
+    };
+    BENCHMARK("clone 16 x 50 parts")
+    {
+        return robot->clone("robot1");
+    };
+}
+
+// Collects the interfaces of a module tree
+static void collect_interfaces(const ModulePtr& module, std::vector<InterfacePtr>& interfaces)
+{
+    if (module->has_facts("interfaces"))
+    {
+        for (const auto& [i, _] : module->get_facts("interfaces"))
+            interfaces.push_back(std::static_pointer_cast<Interface>(i.lock()));
+    }
+    if (module->has_facts("parts"))
+    {
+        for (const auto& [p, _] : module->get_facts("parts"))
+            collect_interfaces(std::static_pointer_cast<Module>(p.lock()), interfaces);
+    }
+}
+
+TEST_CASE("Benchmark cached uris", "[!benchmark][Module]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    for (const std::size_t depth : {4, 16, 64})
+    {
+        // A chain of 20 parts nested into depth levels of composites
+        ComponentModelPtr nested = create_chain_model(pr, 20);
+        for (std::size_t level = 1; level < depth; ++level)
+        {
+            ComponentModelPtr outer = pr->instantiate<ComponentModel>();
+            outer->set_properties({{"name", "Level" + std::to_string(level)}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+            outer->set_all_unknown_facts_empty();
+            nested->instantiate(outer, "inner", true);
+            nested = outer;
+        }
+        ModulePtr robot = nested->build("robot");
+        std::vector<InterfacePtr> interfaces;
+        collect_interfaces(robot, interfaces);
+
+        const std::string suffix(std::to_string(interfaces.size()) + " interfaces of a module tree of depth " + std::to_string(depth));
+        BENCHMARK("uris of " + suffix)
+        {
+            std::size_t length = 0;
+            for (const auto& interface : interfaces)
+                length += interface->uri().size();
+            return length;
+        };
+        std::size_t renames = 0;
+        BENCHMARK("uris of " + suffix + " after renaming the toplvl module")
+        {
+            robot->set_name("robot" + std::to_string(++renames));
+            std::size_t length = 0;
+            for (const auto& interface : interfaces)
+                length += interface->uri().size();
+            return length;
+        };
+        pr->clear();
+    }
+}
+
+TEST_CASE("Benchmark Interface connections", "[!benchmark][Interface]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+    im->set_all_unknown_facts_empty();
+    im->set_properties({{"name", "float"}, {"domain", "SOFTWARE"}});
+    ComponentModelPtr cm = pr->instantiate<ComponentModel>();
+    cm->set_properties({{"name", "Bus"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    cm->set_all_unknown_facts_empty();
+    for (const std::size_t n_peers : {1000, 10000})
+    {
+        InterfacePtr bus = im->instantiate(cm, "bus" + std::to_string(n_peers), "OUTGOING", "N", true);
+        std::vector<InterfacePtr> peers;
+        for (std::size_t i = 0; i < n_peers; ++i)
+            peers.push_back(im->instantiate(cm, "peer" + std::to_string(i) + "_" + std::to_string(n_peers), "INCOMING", "ONE", true));
+
+        BENCHMARK("connect a bus to " + std::to_string(n_peers) + " peers")
+        {
+            bus->disconnect();
+            for (const auto& peer : peers)
+                bus->connected_to(peer);
+            return bus;
+        };
+        std::vector<std::tuple<InterfacePtr, InterfacePtr, nl::json>> connections;
+        for (const auto& peer : peers)
+            connections.emplace_back(bus, peer, nl::json::object());
+        BENCHMARK("connect a bus to " + std::to_string(n_peers) + " peers with connect_all")
+        {
+            bus->disconnect();
+            return Interface::connect_all(connections);
+        };
+        BENCHMARK("query the connections of a bus to " + std::to_string(n_peers) + " peers")
+        {
+            std::size_t connected = 0;
+            for (const auto& peer : peers)
+                connected += bus->is_connected_to(peer);
+            return connected;
+        };
+    }
+}
+
+TEST_CASE("Benchmark ComponentModel::disconnect_parts", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+    im->set_all_unknown_facts_empty();
+    im->set_properties({{"name", "float"}, {"domain", "SOFTWARE"}});
+    ComponentModelPtr node = pr->instantiate<ComponentModel>();
+    node->set_properties({{"name", "Node"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    node->set_all_unknown_facts_empty();
+    im->instantiate(node, "in", "INCOMING", "N", true);
+    im->instantiate(node, "out", "OUTGOING", "N", true);
+    for (const std::size_t n_parts : {50, 100, 200})
+    {
+        // Every part is connected to every other part
+        ComponentModelPtr mesh = pr->instantiate<ComponentModel>();
+        mesh->set_properties({{"name", "Mesh" + std::to_string(n_parts)}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+        mesh->set_all_unknown_facts_empty();
+        std::vector<ComponentPtr> parts;
+        for (std::size_t i = 0; i < n_parts; ++i)
+            parts.push_back(node->instantiate(mesh, "part" + std::to_string(i), true));
+        std::vector<std::tuple<InterfacePtr, InterfacePtr, nl::json>> connections;
+        for (const auto& from : parts)
+            for (const auto& to : parts)
+                if (from != to)
+                    connections.emplace_back(from->get_interface("out"), to->get_interface("in"), nl::json::object());
+
+        BENCHMARK_ADVANCED("disconnect_parts of " + std::to_string(n_parts) + " parts with " + std::to_string(connections.size()) + " connections")(Catch::Benchmark::Chronometer meter)
+        {
+            Interface::connect_all(connections);
+            meter.measure([&] { mesh->disconnect_parts(); });
+        };
+        BENCHMARK_ADVANCED("disconnect every interface of " + std::to_string(n_parts) + " parts with " + std::to_string(connections.size()) + " connections")(Catch::Benchmark::Chronometer meter)
+        {
+            Interface::connect_all(connections);
+            meter.measure([&] {
+                for (const auto& part : parts)
+                    part->get_interface("out")->disconnect();
+            });
+        };
+    }
+}
+
+TEST_CASE("Benchmark connectable interface search", "[!benchmark][Component]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    std::vector<InterfaceModelPtr> types;
+    for (const auto& name : {"float", "double", "int", "string", "pose", "image", "twist", "joint_state"})
+    {
+        InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+        im->set_all_unknown_facts_empty();
+        im->set_properties({{"name", name}, {"domain", "SOFTWARE"}});
+        types.push_back(im);
+    }
+    const std::vector<std::string> directions{"INCOMING", "OUTGOING", "BIDIRECTIONAL"};
+    for (const std::size_t n_interfaces : {50, 200, 500})
+    {
+        // Every part has interfaces of all types and directions
+        ComponentModelPtr node = pr->instantiate<ComponentModel>();
+        node->set_properties({{"name", "Node" + std::to_string(n_interfaces)}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+        node->set_all_unknown_facts_empty();
+        for (std::size_t i = 0; i < n_interfaces; ++i)
+            types[i % types.size()]->instantiate(node, "i" + std::to_string(i), directions[(i / types.size()) % directions.size()], "N", true);
+        ComponentModelPtr whole = pr->instantiate<ComponentModel>();
+        whole->set_properties({{"name", "Whole" + std::to_string(n_interfaces)}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+        whole->set_all_unknown_facts_empty();
+        ComponentPtr a = node->instantiate(whole, "a", true);
+        ComponentPtr b = node->instantiate(whole, "b", true);
+
+        BENCHMARK("find connectable interfaces of two parts with " + std::to_string(n_interfaces) + " interfaces each")
+        {
+            return a->find_connectable_interfaces(b);
+        };
+        BENCHMARK("check is_connectable_to for every pair of interfaces of two parts with " + std::to_string(n_interfaces) + " interfaces each")
+        {
+            // NOTE: is_connectable_to() reports every mismatch on stdout, which is silenced here
+            std::streambuf* const out = std::cout.rdbuf(nullptr);
+            std::map<InterfacePtr, std::vector<InterfacePtr>> result;
+            for (const auto& [i, _] : a->get_facts("interfaces"))
+            {
+                const InterfacePtr from(std::static_pointer_cast<Interface>(i.lock()));
+                for (const auto& [j, _] : b->get_facts("interfaces"))
+                {
+                    const InterfacePtr to(std::static_pointer_cast<Interface>(j.lock()));
+                    if (from->is_connectable_to(to))
+                        result[from].push_back(to);
+                }
+            }
+            std::cout.rdbuf(out);
+            return result;
+        };
+    }
+}
+
+// Creates and commits the leaf model used by create_basic_model(): a component with the inputs in0, in1 and the output out of the same interface model
+static ComponentModelPtr create_leaf_model(XTypeRegistryPtr pr)
+{
+    InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+    im->set_all_unknown_facts_empty();
+    im->set_properties({{"name", "float"}, {"domain", "SOFTWARE"}});
+    ComponentModelPtr leaf = pr->instantiate<ComponentModel>();
+    leaf->set_properties({{"name", "Leaf"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}});
+    leaf->set_all_unknown_facts_empty();
+    im->instantiate(leaf, "in0", "INCOMING", "ONE", true);
+    im->instantiate(leaf, "in1", "INCOMING", "ONE", true);
+    im->instantiate(leaf, "out", "OUTGOING", "N", true);
+    REQUIRE(pr->commit(im, true));
+    REQUIRE(pr->commit(leaf, true));
+    return leaf;
+}
+
+// Creates a serialized model (DROCK BasicModel Json format) with n_versions versions of n_parts parts of the given leaf model and (almost) 2 * n_parts edges
+static std::string create_basic_model(const ComponentModelPtr& leaf, const std::size_t n_parts, const std::size_t n_versions = 1)
+{
+    const nl::json leaf_model = {{"name", leaf->get_name()}, {"domain", leaf->get_domain()}, {"version", leaf->get_version()}};
+    nl::json nodes = nl::json::array();
+    nl::json edges = nl::json::array();
+    for (std::size_t i = 0; i < n_parts; ++i)
+    {
+        nodes.push_back({{"name", "part" + std::to_string(i)}, {"model", leaf_model}});
+        if (i + 1 < n_parts)
+            edges.push_back({{"name", "conn" + std::to_string(i) + "_0"}, {"from", {{"name", "part" + std::to_string(i)}, {"interface", "out"}}}, {"to", {{"name", "part" + std::to_string(i + 1)}, {"interface", "in0"}}}});
+        if (i + 2 < n_parts)
+            edges.push_back({{"name", "conn" + std::to_string(i) + "_1"}, {"from", {{"name", "part" + std::to_string(i)}, {"interface", "out"}}}, {"to", {{"name", "part" + std::to_string(i + 2)}, {"interface", "in1"}}}});
+    }
+    nl::json model = {
+        {"name", "Synthetic" + std::to_string(n_parts)},
+        {"domain", "SOFTWARE"},
+        {"versions", nl::json::array()}
+    };
+    for (std::size_t v = 0; v < n_versions; ++v)
+        model["versions"].push_back({{"name", "v" + std::to_string(v)}, {"components", {{"nodes", nodes}, {"edges", edges}}}});
+    return model.dump();
+}
+
+TEST_CASE("Benchmark ComponentModel::import_from_basic_model", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    ComponentModelPtr leaf = create_leaf_model(pr);
+
+    // The import time should grow linearly with the number of parts (and edges)
+    for (const std::size_t n_parts : {1250, 2500, 5000, 10000})
+    {
+        const std::string serialized_model(create_basic_model(leaf, n_parts));
+        BENCHMARK("import model with " + std::to_string(n_parts) + " parts and " + std::to_string(2 * n_parts - 3) + " edges")
+        {
+            return ComponentModel::import_from_basic_model(serialized_model, pr);
+        };
+    }
+}
+
+TEST_CASE("Benchmark parallel ComponentModel::import_from_basic_model", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    ComponentModelPtr leaf = create_leaf_model(pr);
+
+    // A component family with 32 versions
+    const std::string serialized_model(create_basic_model(leaf, 250, 32));
+    BENCHMARK("import 32 versions x 250 parts serially")
+    {
+        return ComponentModel::import_from_basic_model(serialized_model, pr);
+    };
+    BENCHMARK("import 32 versions x 250 parts in parallel")
+    {
+        return ComponentModel::import_from_basic_model(serialized_model, pr, {{"parallel", true}});
+    };
+}
+
+TEST_CASE("Benchmark binary basic model encodings", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    ComponentModelPtr leaf = create_leaf_model(pr);
+    const std::vector<ComponentModelPtr> models(ComponentModel::import_from_basic_model(create_basic_model(leaf, 2000), pr));
+    REQUIRE(models.size() == 1);
+    const ComponentModelPtr model(models[0]);
+
+    for (const auto& [name, encoding] : std::vector<std::pair<std::string, BasicModelEncoding>>{{"JSON", BasicModelEncoding::JSON}, {"CBOR", BasicModelEncoding::CBOR}, {"MessagePack", BasicModelEncoding::MSGPACK}})
+    {
+        const std::vector<std::uint8_t> encoded(export_to_basic_model(model, encoding));
+        std::cout << "2000 parts encoded as " << name << ": " << encoded.size() << " bytes\n";
+        BENCHMARK("export 2000 parts as " + name)
+        {
+            return export_to_basic_model(model, encoding);
+        };
+        BENCHMARK("import 2000 parts from " + name)
+        {
+            return import_from_basic_model(encoded, encoding, pr);
+        };
+    }
+}
+
+TEST_CASE("Benchmark ComponentModel::export_many", "[!benchmark][ComponentModel]")
+{
+    XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
+    std::vector<ComponentModelPtr> catalog;
+    for (std::size_t i = 0; i < 64; ++i)
+        catalog.push_back(create_chain_model(pr, 100));
+
+    BENCHMARK("export 64 x 100 parts serially")
+    {
+        std::vector<std::string> exports;
+        for (const auto& model : catalog)
+            exports.push_back(model->export_to_basic_model());
+        return exports;
+    };
+    BENCHMARK("export 64 x 100 parts with export_many")
+    {
+        return ComponentModel::export_many(catalog);
+    };
+}
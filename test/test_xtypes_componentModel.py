@@ -163,6 +163,26 @@ class TestComponentModel(unittest.TestCase):
         assert test.get_properties()["name"] == "test"
 
 
+    def test_build_report(self):
+        registry = ProjectRegistry()
+        cm = ComponentModel()
+        cm.set_all_unknown_facts_empty()
+        cm.set_properties({"name": "Leaf", "domain": "SOFTWARE", "version": "v0.1"})
+        whole = ComponentModel()
+        whole.set_all_unknown_facts_empty()
+        whole.set_properties({"name": "Whole", "domain": "SOFTWARE", "version": "v0.1"})
+        registry.commit(cm, True)
+        registry.commit(whole, True)
+        cm.instantiate(whole, "first", True)
+        cm.instantiate(whole, "second", True)
+        whole.build("whole", None, {"report": True})
+        report = ComponentModel.get_last_build_report()
+        assert report["source"] == "build"
+        assert report["phases"]["instantiation"]["modules"] == 3
+        for phase in ["expansion", "abstract_resolution", "alias_resolution", "instantiation", "wiring"]:
+            assert report["phases"][phase]["wall_time_ms"] >= 0.0
+
+
 
 if __name__ == '__main__':
     unittest.main()
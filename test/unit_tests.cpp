@@ -1,6 +1,10 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 // Include XTypes
 #include <xtypes_generator/utils.hpp>
 
@@ -12,6 +16,7 @@
 #include "Module.hpp"
 #include "ProjectRegistry.hpp"
 #include "git_wrapper.hpp"
+#include "BasicModelStream.hpp"
 
 
 static std::once_flag onceFlag;
@@ -98,14 +103,114 @@ TEST_CASE("Test Interface class interface", "Interface")
         REQUIRE(i1->get_facts("from_others").size() == 1);
         REQUIRE(i2->get_facts("from_others").size() == 1);
         // TODO: Check connection with properties
+        REQUIRE(i->is_connected_to(i1));
+        REQUIRE_FALSE(i1->is_connected_to(i));
+        // Connecting again keeps the connection
+        REQUIRE(i->connected_to(i1, {}) == true);
+        REQUIRE(i->get_facts("others").size() == 2);
+        // Connections removed through the XType interface are noticed as well
+        std::static_pointer_cast<XType>(i)->remove_fact("others", i2);
+        REQUIRE_FALSE(i->is_connected_to(i2));
+        REQUIRE(i->is_connected_to(i1));
+        i2->remove_fact("from_others", i);
+        REQUIRE(i->connected_to(i2, {}) == true);
+        REQUIRE(i->is_connected_to(i2));
+        // So is a connection replaced by another one through the XType interface (which keeps the number of facts)
+        InterfacePtr i3 = im->instantiate(cm, "d", "DIRECTION_NOT_SET", "MULTIPLICITY_NOT_SET", true);
+        REQUIRE_FALSE(i->is_connected_to(i3));
+        std::static_pointer_cast<XType>(i)->remove_fact("others", i1);
+        i1->remove_fact("from_others", i);
+        std::static_pointer_cast<XType>(i)->add_fact("others", i3);
+        REQUIRE(i->get_facts("others").size() == 2);
+        REQUIRE_FALSE(i->is_connected_to(i1));
+        REQUIRE(i->is_connected_to(i3));
+        REQUIRE(i->is_connected_to(i2));
+        REQUIRE(i->connected_to(i1, {}) == true);
         i->disconnect();
         REQUIRE(i->get_facts("others").size() == 0);
         REQUIRE(i1->get_facts("from_others").size() == 0);
         REQUIRE(i2->get_facts("from_others").size() == 0);
+        REQUIRE_FALSE(i->is_connected_to(i1));
+        REQUIRE_FALSE(i->is_connected_to(i2));
+        // Both directions of all connections of a group of interfaces can be removed at once
+        REQUIRE(i->connected_to(i1, {}));
+        REQUIRE(i1->connected_to(i2, {}));
+        REQUIRE(i2->connected_to(i, {}));
+        Interface::disconnect_all({i, i1});
+        for (const auto& interface : {i, i1, i2})
+        {
+            REQUIRE(interface->get_facts("others").size() == 0);
+            REQUIRE(interface->get_facts("from_others").size() == 0);
+        }
+        REQUIRE_FALSE(i2->is_connected_to(i));
+        // A destroyed peer is not mistaken for an interface which reuses its address
+        {
+            InterfacePtr gone = std::make_shared<Interface>();
+            std::static_pointer_cast<XType>(i)->add_fact("others", gone);
+            REQUIRE(i->is_connected_to(gone));
+        }
+        REQUIRE_FALSE(i->is_connected_to(std::make_shared<Interface>()));
+        // Removing a connection moves the last one into its place, which is still found afterwards
+        i->disconnect();
+        for (const auto& interface : {i1, i2, i3})
+            REQUIRE(interface->connected_to(i, {}));
+        i1->disconnect();
+        REQUIRE(i->get_facts("from_others").size() == 2);
+        REQUIRE(i->get_facts("from_others").front().target.lock() == i3);
+        i2->disconnect();
+        REQUIRE(i->get_facts("from_others").size() == 1);
+        REQUIRE(i->get_facts("from_others").front().target.lock() == i3);
+        i3->disconnect();
+        REQUIRE(i->get_facts("from_others").size() == 0);
     }
     
     pr->clear();
 
+    SECTION("connect_all")
+    {
+        InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+        im->set_name("im");
+        InterfaceModelPtr other_im = pr->instantiate<InterfaceModel>();
+        other_im->set_name("other_im");
+        ComponentModelPtr cm = pr->instantiate<ComponentModel>();
+        InterfacePtr bus = im->instantiate(cm, "bus", "OUTGOING", "N", true);
+        InterfacePtr single = im->instantiate(cm, "single", "OUTGOING", "ONE", true);
+        InterfacePtr a = im->instantiate(cm, "a", "INCOMING", "ONE", true);
+        InterfacePtr b = im->instantiate(cm, "b", "INCOMING", "N", true);
+        InterfacePtr c = im->instantiate(cm, "c", "OUTGOING", "N", true);
+        InterfacePtr d = other_im->instantiate(cm, "d", "INCOMING", "N", true);
+        REQUIRE(bus->connected_to(b, {{"name", "existing"}}));
+        const nl::json rejected = Interface::connect_all({
+            {bus, a, {{"name", "bus_a"}}},
+            {bus, b, {{"name", "ignored"}}},
+            {single, a, nl::json::object()},
+            {single, b, nl::json::object()},
+            {single, b, nl::json::object()},
+            {bus, c, nl::json::object()},
+            {bus, d, nl::json::object()},
+            {bus, nullptr, nl::json::object()},
+            {bus, a, {{"name", "ignored"}}}
+        });
+        REQUIRE(rejected.size() == 4);
+        std::vector<std::size_t> rejected_indices;
+        for (const auto& r : rejected)
+            rejected_indices.push_back(r["index"].get<std::size_t>());
+        REQUIRE(rejected_indices == std::vector<std::size_t>{2, 5, 6, 7});
+        REQUIRE(rejected[0]["reason"] == "Multiplicity of target interface is violated");
+        REQUIRE(rejected[1]["reason"] == "Direction mismatch");
+        REQUIRE(rejected[2]["reason"] == "Type mismatch");
+        REQUIRE(rejected[0]["from"] == single->uri());
+        REQUIRE(bus->is_connected_to(a));
+        REQUIRE(single->is_connected_to(b));
+        REQUIRE_FALSE(single->is_connected_to(a));
+        REQUIRE(bus->get_facts("others").size() == 2);
+        REQUIRE(b->get_facts("from_others").size() == 2);
+        for (const auto& [o, props] : bus->get_facts("others"))
+            REQUIRE(props["name"] == ((o.lock() == a) ? "bus_a" : "existing"));
+    }
+
+    pr->clear();
+
     SECTION("get_dynamic_interface")
     {
         // First setup a component model with a dynamic interface
@@ -196,6 +301,32 @@ TEST_CASE("Test ComponentModel class interface", "ComponentModel")
 {
     XTypeRegistryPtr pr = std::make_shared<ProjectRegistry>();
 
+    // Creates a whole model with the parts "first" and "second" of a leaf model. The "out" interface of the first part is connected to the "in" interface of the second one.
+    struct LeafParts
+    {
+        ComponentModelPtr whole_cm;
+        ComponentModelPtr leaf_cm;
+        InterfaceModelPtr some_im;
+        ComponentPtr first;
+        ComponentPtr second;
+    };
+    auto create_leaf_parts = [&pr](const std::string& whole_name) -> LeafParts
+    {
+        ComponentModelPtr whole_cm = pr->instantiate<ComponentModel>();
+        whole_cm->set_name(whole_name);
+        whole_cm->set_all_unknown_facts_empty();
+        ComponentModelPtr leaf_cm = pr->instantiate<ComponentModel>();
+        leaf_cm->set_name("leaf_cm");
+        leaf_cm->set_all_unknown_facts_empty();
+        InterfaceModelPtr some_im = pr->instantiate<InterfaceModel>();
+        some_im->instantiate(leaf_cm, "in", "INCOMING", "ONE", true);
+        some_im->instantiate(leaf_cm, "out", "OUTGOING", "N", true);
+        ComponentPtr first = leaf_cm->instantiate(whole_cm, "first", true);
+        ComponentPtr second = leaf_cm->instantiate(whole_cm, "second", true);
+        REQUIRE(first->get_interface("out")->connected_to(second->get_interface("in")));
+        return {whole_cm, leaf_cm, some_im, first, second};
+    };
+
     SECTION("composed_of")
     {
         ComponentModelPtr cm = pr->instantiate<ComponentModel>();
@@ -264,6 +395,333 @@ TEST_CASE("Test ComponentModel class interface", "ComponentModel")
 
     pr->clear();
 
+    SECTION("build in parallel")
+    {
+        auto [inner_cm, leaf_cm, some_im, first, second] = create_leaf_parts("inner_cm");
+        ComponentModelPtr root_cm = pr->instantiate<ComponentModel>();
+        root_cm->set_name("root");
+        root_cm->set_all_unknown_facts_empty();
+        for (int i = 0; i < 8; ++i)
+            inner_cm->instantiate(root_cm, "inner" + std::to_string(i), true);
+        ModulePtr module = root_cm->build("built_root", nullptr, {{"parallel", true}, {"max_threads", 4}});
+        REQUIRE(module->get_facts("parts").size() == 8);
+        for (int i = 0; i < 8; ++i)
+        {
+            ModulePtr inner = module->get_part("inner" + std::to_string(i));
+            REQUIRE(inner);
+            REQUIRE(inner->get_type()->uuid() == inner_cm->uuid());
+            REQUIRE(inner->get_facts("parts").size() == 2);
+            InterfacePtr out = inner->get_part("first")->get_interface("out");
+            REQUIRE(out->get_type()->uuid() == some_im->uuid());
+            REQUIRE(out->is_connected_to(inner->get_part("second")->get_interface("in")));
+        }
+    }
+
+    pr->clear();
+
+    SECTION("build with cached plan")
+    {
+        ComponentModel::forget_build_plans();
+        auto [root_cm, leaf_cm, some_im, first, second] = create_leaf_parts("root");
+        root_cm->export_inner_interface(first->get_interface("in"), true);
+        for (int i = 0; i < 2; ++i)
+        {
+            // The second build replays the plan compiled by the first one
+            ModulePtr module = root_cm->build("built_root", nullptr, {{"cache_plan", true}});
+            REQUIRE(module->get_facts("parts").size() == 2);
+            REQUIRE(module->get_facts("interfaces").size() == 1);
+            InterfacePtr alias = std::static_pointer_cast<Interface>(module->get_facts("interfaces")[0].target.lock());
+            REQUIRE(alias->get_facts("original").size() == 1);
+            REQUIRE(alias->get_facts("original")[0].target.lock()->uuid() == module->get_part("first")->get_interface("in")->uuid());
+            REQUIRE(module->get_part("first")->get_interface("out")->is_connected_to(module->get_part("second")->get_interface("in")));
+        }
+        // After modifying the model, the cached plan is not replayed anymore
+        leaf_cm->instantiate(root_cm, "third", true);
+        ModulePtr module = root_cm->build("built_root", nullptr, {{"cache_plan", true}, {"report", true}});
+        REQUIRE(ComponentModel::get_last_build_report()["source"] == "build");
+        REQUIRE(module->get_facts("parts").size() == 3);
+        // So is a modification of a part model
+        some_im->instantiate(leaf_cm, "extra", "INCOMING", "ONE", true);
+        module = root_cm->build("built_root", nullptr, {{"cache_plan", true}, {"report", true}});
+        REQUIRE(ComponentModel::get_last_build_report()["source"] == "build");
+        REQUIRE(module->get_part("first")->get_facts("interfaces").size() == 3);
+        // Modifications through the XType interface are not counted, so the cached plans have to be forgotten
+        root_cm->remove_fact("parts", root_cm->get_part("third"));
+        ComponentModel::forget_build_plans();
+        module = root_cm->build("built_root", nullptr, {{"cache_plan", true}});
+        REQUIRE(module->get_facts("parts").size() == 2);
+        // The cache does not keep the models alive
+        const std::weak_ptr<ComponentModel> weak_root(root_cm);
+        module.reset();
+        first.reset();
+        second.reset();
+        root_cm.reset();
+        leaf_cm.reset();
+        some_im.reset();
+        pr->clear();
+        REQUIRE(weak_root.expired());
+    }
+
+    pr->clear();
+
+    SECTION("rebuild_from")
+    {
+        auto [root_cm, leaf_cm, some_im, first, second] = create_leaf_parts("root");
+        ModulePtr module = root_cm->build("built_root");
+        ModulePtr first_module = module->get_part("first");
+        first_module->configure({{"first", {{"gain", 42}}}});
+        REQUIRE(first_module->get_configuration()["gain"] == 42);
+
+        // Add a third part and connect it
+        ComponentPtr third = leaf_cm->instantiate(root_cm, "third", true);
+        REQUIRE(second->get_interface("out")->connected_to(third->get_interface("in")));
+        module->rebuild_from(root_cm);
+        REQUIRE(module->get_facts("parts").size() == 3);
+        // Unchanged submodules have been kept with their configuration
+        REQUIRE(module->get_part("first") == first_module);
+        REQUIRE(first_module->get_configuration()["gain"] == 42);
+        REQUIRE(first_module->get_interface("out")->is_connected_to(module->get_part("second")->get_interface("in")));
+        REQUIRE(module->get_part("second")->get_interface("out")->is_connected_to(module->get_part("third")->get_interface("in")));
+
+        // Remove the second part again
+        second->get_interface("out")->disconnect();
+        first->get_interface("out")->disconnect();
+        root_cm->remove_fact("parts", second);
+        second->remove_fact("whole", root_cm);
+        module->rebuild_from(root_cm);
+        REQUIRE(module->get_facts("parts").size() == 2);
+        REQUIRE(module->get_part("second") == nullptr);
+        REQUIRE(module->get_part("first") == first_module);
+        REQUIRE(first_module->get_interface("out")->get_facts("others").size() == 0);
+        REQUIRE(module->get_part("third")->get_interface("in")->get_facts("from_others").size() == 0);
+    }
+
+    pr->clear();
+
+    SECTION("clone")
+    {
+        auto [root_cm, leaf_cm, some_im, first, second] = create_leaf_parts("root");
+        ComponentPtr third = leaf_cm->instantiate(root_cm, "third", true);
+        REQUIRE(first->get_interface("out")->connected_to(third->get_interface("in")));
+        root_cm->export_inner_interface(first->get_interface("in"), true);
+        ModulePtr module = root_cm->build("robot0");
+        module->get_part("first")->configure({{"first", {{"gain", 42}}}});
+
+        ModulePtr copy = module->clone("robot1");
+        REQUIRE(copy != module);
+        REQUIRE(copy->get_name() == "robot1");
+        REQUIRE(copy->get_type() == root_cm);
+        REQUIRE(copy->get_facts("whole").size() == 0);
+        REQUIRE(copy->get_facts("parts").size() == 3);
+        ModulePtr first_copy = copy->get_part("first");
+        REQUIRE(first_copy != module->get_part("first"));
+        REQUIRE(first_copy->get_type() == leaf_cm);
+        REQUIRE(first_copy->get_configuration()["gain"] == 42);
+        REQUIRE(first_copy->uri() != module->get_part("first")->uri());
+        // Connections and aliases are remapped to the copies
+        REQUIRE(first_copy->get_interface("out")->is_connected_to(copy->get_part("second")->get_interface("in")));
+        REQUIRE_FALSE(first_copy->get_interface("out")->is_connected_to(module->get_part("second")->get_interface("in")));
+        REQUIRE(copy->get_facts("interfaces").size() == 1);
+        InterfacePtr exported = std::static_pointer_cast<Interface>(copy->get_facts("interfaces")[0].target.lock());
+        REQUIRE(exported->get_facts("original").size() == 1);
+        REQUIRE(exported->get_facts("original")[0].target.lock() == first_copy->get_interface("in"));
+        // The connections of the copies are in the same order as the ones of the originals
+        auto peers_of = [](const InterfacePtr& interface) {
+            std::vector<std::string> names;
+            for (const auto& [o, _] : interface->get_facts("others"))
+                names.push_back(std::static_pointer_cast<Module>(o.lock()->get_facts("parent")[0].target.lock())->get_name());
+            return names;
+        };
+        REQUIRE(peers_of(first_copy->get_interface("out")) == std::vector<std::string>{"second", "third"});
+        REQUIRE(peers_of(module->clone("robot2")->get_part("first")->get_interface("out")) == peers_of(first_copy->get_interface("out")));
+        // The original is untouched
+        REQUIRE(module->get_part("first")->get_interface("out")->get_facts("others").size() == 2);
+    }
+
+    pr->clear();
+
+    SECTION("cached uris")
+    {
+        const LeafParts parts(create_leaf_parts("root"));
+        const ComponentModelPtr& leaf_cm(parts.leaf_cm);
+        ModulePtr module = parts.whole_cm->build("robot0");
+        ModulePtr first = module->get_part("first");
+        InterfacePtr in = first->get_interface("in");
+        const std::string module_uri(module->uri());
+        const std::string first_uri(first->uri());
+        const std::string in_uri(in->uri());
+        REQUIRE(in_uri == in->_Interface::uri());
+        REQUIRE(in->uri() == in_uri);
+        REQUIRE(in->uuid() == in->XType::uuid());
+
+        // Renaming the toplvl module reaches the uris of its parts and their interfaces
+        const std::size_t in_uuid(in->uuid());
+        module->set_name("robot1");
+        REQUIRE(module->uri() != module_uri);
+        REQUIRE(in->uuid() != in_uuid);
+        REQUIRE(first->uri() != first_uri);
+        REQUIRE(in->uri() != in_uri);
+        REQUIRE(in->uri() == in->_Interface::uri());
+        REQUIRE(first->uri() == first->_Module::uri());
+
+        // So do changes of the properties and relations of the interface itself
+        in->set_property("direction", "OUTGOING");
+        REQUIRE(in->uri() == in->_Interface::uri());
+        ModulePtr other = pr->instantiate<Module>();
+        other->set_name("other");
+        other->set_all_unknown_facts_empty();
+        in->remove_fact("parent", first);
+        in->add_parent(other);
+        REQUIRE(in->uri() == in->_Interface::uri());
+        REQUIRE(in->uri().find("other") != std::string::npos);
+        // Changes through the XType interface and the generated base classes are detected as well
+        std::static_pointer_cast<XType>(other)->set_property("name", "another");
+        REQUIRE(in->uri().find("another") != std::string::npos);
+        std::static_pointer_cast<XType>(in)->set_property("name", "renamed");
+        REQUIRE(in->uri() == in->_Interface::uri());
+        REQUIRE(in->uri().find("renamed") != std::string::npos);
+        in->_Interface::set_direction("INCOMING");
+        REQUIRE(in->uri() == in->_Interface::uri());
+        REQUIRE(in->uuid() == in->XType::uuid());
+        first->_Module::set_name("primus");
+        REQUIRE(first->uri() == first->_Module::uri());
+        std::static_pointer_cast<XType>(module)->set_property("name", "robot2");
+        REQUIRE(first->uri() == first->_Module::uri());
+        REQUIRE(first->uri().find("robot2") != std::string::npos);
+        REQUIRE(first->uuid() == std::static_pointer_cast<XType>(first)->uuid());
+        // So are changes of the model
+        const std::string model_uri(leaf_cm->uri());
+        std::static_pointer_cast<XType>(leaf_cm)->set_property("version", "v2.0");
+        REQUIRE(leaf_cm->uri() != model_uri);
+        REQUIRE(first->uri() == first->_Module::uri());
+        REQUIRE(first->uri().find("v2.0") != std::string::npos);
+    }
+
+    pr->clear();
+
+    SECTION("build with max_depth and subtree")
+    {
+        auto [mid_cm, leaf_cm, some_im, first, second] = create_leaf_parts("mid_cm");
+        mid_cm->export_inner_interface(first->get_interface("in"), true);
+        mid_cm->export_inner_interface(second->get_interface("out"), true);
+        ComponentModelPtr root_cm = pr->instantiate<ComponentModel>();
+        root_cm->set_name("root");
+        root_cm->set_all_unknown_facts_empty();
+        ComponentPtr a = mid_cm->instantiate(root_cm, "a", true);
+        ComponentPtr b = mid_cm->instantiate(root_cm, "b", true);
+        REQUIRE(a->get_interface("second:out")->connected_to(b->get_interface("first:in")));
+
+        // Only the toplvl parts are built, but they are still connected
+        ModulePtr shallow = root_cm->build("shallow", nullptr, {{"max_depth", 1}});
+        REQUIRE(shallow->get_facts("parts").size() == 2);
+        REQUIRE(shallow->get_part("a")->is_atomic());
+        REQUIRE_FALSE(shallow->get_part("a")->get_type()->is_atomic());
+        REQUIRE(shallow->get_part("a")->get_interface("second:out")->is_connected_to(shallow->get_part("b")->get_interface("first:in")));
+        REQUIRE(root_cm->build("none", nullptr, {{"max_depth", 0}})->is_atomic());
+
+        // Only b gets expanded
+        ModulePtr scoped = root_cm->build("scoped", nullptr, {{"subtree", {"b"}}});
+        REQUIRE(scoped->get_part("a")->is_atomic());
+        REQUIRE(scoped->get_part("b")->get_facts("parts").size() == 2);
+        REQUIRE(scoped->get_part("b")->get_part("first")->get_interface("out")->is_connected_to(scoped->get_part("b")->get_part("second")->get_interface("in")));
+        REQUIRE(scoped->get_part("a")->get_interface("second:out")->is_connected_to(scoped->get_part("b")->get_interface("first:in")));
+
+        // The parts on the way to a subtree are expanded as well
+        ModulePtr deep = root_cm->build("deep", nullptr, {{"subtree", {"a/first"}}});
+        REQUIRE(deep->get_part("a")->get_facts("parts").size() == 2);
+        REQUIRE(deep->get_part("b")->is_atomic());
+
+        REQUIRE_THROWS(root_cm->build("missing", nullptr, {{"subtree", {"c"}}}));
+    }
+
+    pr->clear();
+
+    SECTION("build with persistent cache")
+    {
+        const std::string cache_dir((fs::temp_directory_path() / "xtypes_build_cache_test").string());
+        fs::remove_all(cache_dir);
+        auto [root_cm, leaf_cm, some_im, first, second] = create_leaf_parts("root");
+        root_cm->export_inner_interface(first->get_interface("in"), true);
+
+        ModulePtr built = root_cm->build("robot", nullptr, {{"cache_dir", cache_dir}});
+        REQUIRE(std::distance(fs::directory_iterator(cache_dir), fs::directory_iterator()) == 1);
+        ModulePtr loaded = root_cm->build("robot2", nullptr, {{"cache_dir", cache_dir}});
+        REQUIRE(loaded != built);
+        REQUIRE(loaded->get_name() == "robot2");
+        REQUIRE(loaded->get_type() == root_cm);
+        REQUIRE(loaded->get_facts("parts").size() == 2);
+        REQUIRE(loaded->get_part("first")->get_type() == leaf_cm);
+        REQUIRE(loaded->get_part("first")->get_interface("out")->is_connected_to(loaded->get_part("second")->get_interface("in")));
+        REQUIRE(loaded->get_facts("interfaces").size() == 1);
+        InterfacePtr exported = std::static_pointer_cast<Interface>(loaded->get_facts("interfaces")[0].target.lock());
+        REQUIRE(exported->get_facts("original")[0].target.lock() == loaded->get_part("first")->get_interface("in"));
+
+        // Connections of a cached tree are checked again. An invalid one makes the entry invalid.
+        const fs::path cache_file(fs::directory_iterator(cache_dir)->path());
+        nl::json cached;
+        {
+            std::ifstream in(cache_file.string(), std::ios::binary);
+            cached = nl::json::from_cbor(std::vector<std::uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+        }
+        REQUIRE(cached["connections"].size() == 1);
+        cached["connections"][0][1] = cached["connections"][0][0];
+        {
+            std::ofstream out(cache_file.string(), std::ios::binary);
+            const std::vector<std::uint8_t> data(nl::json::to_cbor(cached));
+            out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        }
+        ModulePtr rebuilt = root_cm->build("robot3", nullptr, {{"cache_dir", cache_dir}, {"report", true}});
+        REQUIRE(ComponentModel::get_last_build_report()["source"] == "build");
+        REQUIRE(rebuilt->get_part("first")->get_interface("out")->is_connected_to(rebuilt->get_part("second")->get_interface("in")));
+        REQUIRE_FALSE(rebuilt->get_part("first")->get_interface("out")->is_connected_to(rebuilt->get_part("first")->get_interface("out")));
+
+        // Changing the model changes the key
+        leaf_cm->instantiate(root_cm, "third", true);
+        REQUIRE(root_cm->build("robot", nullptr, {{"cache_dir", cache_dir}})->get_facts("parts").size() == 3);
+        REQUIRE(std::distance(fs::directory_iterator(cache_dir), fs::directory_iterator()) == 2);
+        // So does adding a dynamic interface
+        some_im->instantiate_dynamic(root_cm);
+        root_cm->build("robot", nullptr, {{"cache_dir", cache_dir}});
+        REQUIRE(std::distance(fs::directory_iterator(cache_dir), fs::directory_iterator()) == 3);
+        // Lazy builds are not stored
+        leaf_cm->instantiate(root_cm, "fourth", true);
+        ModulePtr lazy = root_cm->build("robot", nullptr, {{"cache_dir", cache_dir}, {"lazy", true}});
+        REQUIRE(std::distance(fs::directory_iterator(cache_dir), fs::directory_iterator()) == 3);
+        REQUIRE(lazy->get_part("fourth"));
+        fs::remove_all(cache_dir);
+    }
+
+    pr->clear();
+
+    SECTION("build with report")
+    {
+        auto [root_cm, leaf_cm, some_im, first, second] = create_leaf_parts("root");
+        root_cm->export_inner_interface(first->get_interface("in"), true);
+
+        root_cm->build("robot", nullptr, {{"report", true}});
+        nl::json report = ComponentModel::get_last_build_report();
+        REQUIRE(report["source"] == "build");
+        REQUIRE(report["total_wall_time_ms"].get<double>() >= 0.0);
+        for (const std::string phase : {"expansion", "abstract_resolution", "alias_resolution", "instantiation", "wiring"})
+        {
+            REQUIRE(report["phases"].contains(phase));
+            REQUIRE(report["phases"][phase]["wall_time_ms"].get<double>() >= 0.0);
+        }
+        REQUIRE(report["phases"]["instantiation"]["modules"] == 3);
+        REQUIRE(report["phases"]["instantiation"]["interfaces"] == 5);
+        REQUIRE(report["phases"]["instantiation"]["instantiations"] == 8);
+        REQUIRE(report["phases"]["alias_resolution"]["aliases"] == 1);
+        REQUIRE(report["phases"]["wiring"]["connections"] == 1);
+        REQUIRE(report["phases"]["wiring"]["warnings"] == 0);
+
+        root_cm->build("robot", nullptr, {{"report", true}, {"cache_plan", true}});
+        root_cm->build("robot", nullptr, {{"report", true}, {"cache_plan", true}});
+        REQUIRE(ComponentModel::get_last_build_report()["source"] == "cached_plan");
+        ComponentModel::forget_build_plans();
+    }
+
+    pr->clear();
+
     SECTION("has")
     {
         InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
@@ -321,6 +779,63 @@ TEST_CASE("Test ComponentModel class interface", "ComponentModel")
 
     pr->clear();
 
+    SECTION("find_connectable_part_interfaces")
+    {
+        InterfaceModelPtr im = pr->instantiate<InterfaceModel>();
+        im->set_name("im");
+        InterfaceModelPtr im2 = pr->instantiate<InterfaceModel>();
+        im2->set_name("im2");
+        ComponentModelPtr cm = pr->instantiate<ComponentModel>();
+        im->instantiate(cm, "out", "OUTGOING", "N");
+        im->instantiate(cm, "in", "INCOMING", "ONE");
+        im->instantiate(cm, "bi", "BIDIRECTIONAL", "N");
+        im2->instantiate(cm, "other", "INCOMING", "N");
+        ComponentModelPtr cm2 = pr->instantiate<ComponentModel>();
+        cm2->set_name("a whole");
+        ComponentPtr x = cm->instantiate(cm2, "X");
+        ComponentPtr y = cm->instantiate(cm2, "Y");
+        // Interfaces of the same part are never paired
+        auto connectable = cm2->find_connectable_part_interfaces();
+        REQUIRE(connectable.size() == 6);
+        for (const auto& [from, tos] : connectable)
+        {
+            REQUIRE(tos.size() == 1);
+            REQUIRE(from->get_facts("parent")[0].target.lock() != tos[0]->get_facts("parent")[0].target.lock());
+        }
+        REQUIRE(connectable[x->get_interface("out")] == std::vector<InterfacePtr>{y->get_interface("in")});
+        REQUIRE(connectable[x->get_interface("bi")] == std::vector<InterfacePtr>{y->get_interface("bi")});
+        REQUIRE(connectable.count(x->get_interface("other")) == 0);
+        // Interfaces with multiplicity ONE are not connectable anymore once they are connected
+        REQUIRE(x->get_interface("out")->connected_to(y->get_interface("in")));
+        connectable = cm2->find_connectable_part_interfaces();
+        REQUIRE(connectable.size() == 4);
+        REQUIRE(connectable.count(x->get_interface("out")) == 0);
+        REQUIRE(connectable.count(y->get_interface("in")) == 0);
+        // The result has to match the pairwise checks
+        const auto between = x->find_connectable_interfaces(y);
+        std::size_t pairs = 0;
+        for (const auto& [i, _] : x->get_facts("interfaces"))
+        {
+            const InterfacePtr from(std::static_pointer_cast<Interface>(i.lock()));
+            for (const auto& [j, _] : y->get_facts("interfaces"))
+            {
+                const InterfacePtr to(std::static_pointer_cast<Interface>(j.lock()));
+                if (!from->is_connectable_to(to))
+                    continue;
+                ++pairs;
+                REQUIRE(between.count(from) == 1);
+                REQUIRE(std::count(between.at(from).begin(), between.at(from).end(), to) == 1);
+            }
+        }
+        std::size_t found = 0;
+        for (const auto& [_, tos] : between)
+            found += tos.size();
+        REQUIRE(found == pairs);
+        REQUIRE(pairs == 2);
+    }
+
+    pr->clear();
+
     SECTION("derive_domain_from_parts")
     {
         ComponentModelPtr cm = pr->instantiate<ComponentModel>();
@@ -536,6 +1051,263 @@ TEST_CASE("Test ComponentModel real-world example", "ComponentModel")
             REQUIRE(r->uuid() == cm2->uuid());
             ////std::cout << r->uuid() << " ==" << cm2->uuid();
         }
+
+        const fs::path path(fs::temp_directory_path() / "xtypes_basic_model_test.json");
+        // Imports the model with a configuration for its connection
+        auto import_configured = [&]() -> ComponentModelPtr
+        {
+            nl::json configured_json = exported_json;
+            configured_json["name"] = "ConfiguredCascadedController";
+            configured_json["versions"][0]["components"]["configuration"]["edges"] = {{{"name", "test"}, {"buffer_size", 1}}, {{"name", "test"}, {"buffer_size", 5}}};
+            std::vector<ComponentModelPtr> configured = ComponentModel::import_from_basic_model(configured_json.dump(), import_reg);
+            REQUIRE(configured.size() == 1);
+            return configured[0];
+        };
+
+        SECTION("Streaming")
+        {
+            // The same model can be streamed from a file or any std::istream
+            {
+                std::ofstream out(path.string());
+                out << exported_json_str;
+            }
+            std::istringstream in(exported_json_str);
+            for (const auto& streamed : {ComponentModel::import_from_basic_model_file(path.string(), import_reg), import_from_basic_model(in, import_reg)})
+            {
+                REQUIRE(streamed.size() == 1);
+                REQUIRE(streamed[0]->uuid() == cm2->uuid());
+                REQUIRE(streamed[0]->get_facts("parts").size() == imported[0]->get_facts("parts").size());
+                REQUIRE(streamed[0]->get_facts("interfaces").size() == imported[0]->get_facts("interfaces").size());
+                REQUIRE(nl::json::parse(streamed[0]->export_to_basic_model()) == nl::json::parse(cm2->export_to_basic_model()));
+            }
+            fs::remove(path);
+            REQUIRE_THROWS(ComponentModel::import_from_basic_model_file(path.string(), import_reg));
+        }
+
+        SECTION("Encodings")
+        {
+            // The binary encodings share the schema of the text format
+            REQUIRE(nl::json::from_cbor(export_to_basic_model(cm2, BasicModelEncoding::CBOR)) == exported_json);
+            for (const auto encoding : {BasicModelEncoding::JSON, BasicModelEncoding::CBOR, BasicModelEncoding::MSGPACK})
+            {
+                const std::vector<std::uint8_t> encoded(export_to_basic_model(cm2, encoding));
+                std::vector<ComponentModelPtr> decoded = import_from_basic_model(encoded, encoding, import_reg);
+                REQUIRE(decoded.size() == 1);
+                REQUIRE(decoded[0]->uuid() == cm2->uuid());
+                REQUIRE(decoded[0]->export_to_basic_model_json() == cm2->export_to_basic_model_json());
+                std::istringstream encoded_in(std::string(encoded.begin(), encoded.end()));
+                REQUIRE(import_from_basic_model(encoded_in, import_reg, nl::json::object(), encoding).size() == 1);
+            }
+            REQUIRE_THROWS(import_from_basic_model(std::vector<std::uint8_t>{0xa1, 0x64}, BasicModelEncoding::CBOR, import_reg));
+            REQUIRE_THROWS(ComponentModel::import_from_basic_model("{\"name\": ", import_reg));
+        }
+
+        SECTION("Validation")
+        {
+            // A model can be validated without importing it
+            REQUIRE(ComponentModel::validate_basic_model(exported_json_str, import_reg) == nl::json::array());
+            nl::json broken_json = exported_json;
+            nl::json& broken_components = broken_json["versions"][0]["components"];
+            REQUIRE(broken_components["edges"].size() > 0);
+            broken_components["edges"][0]["to"]["name"] = "missing_part";
+            broken_components["nodes"].push_back({{"name", "unknown"}, {"model", {{"name", "Unknown"}, {"domain", "SOFTWARE"}, {"version", "v0.0"}}}});
+            broken_components["configuration"]["edges"] = {{{"name", "missing_connection"}}};
+            broken_json["versions"].push_back({{"versions", "without name"}});
+            XTypeRegistryPtr validation_reg = std::make_shared<ProjectRegistry>();
+            validation_reg->set_load_func([&](const std::string& uri) -> XTypePtr {
+                XTypeCPtr lookup = pr->get_by_uri(uri);
+                if (lookup)
+                    validation_reg->commit(lookup, true);
+                return lookup;
+            });
+            const nl::json validation_errors = ComponentModel::validate_basic_model(broken_json.dump(), validation_reg);
+            std::set<std::string> error_paths;
+            for (const auto& error : validation_errors)
+            {
+                REQUIRE(error["message"].is_string());
+                error_paths.insert(error["path"].get<std::string>());
+            }
+            REQUIRE(error_paths == std::set<std::string>{
+                "/versions/0/components/edges/0/to/name",
+                "/versions/0/components/nodes/" + std::to_string(broken_components["nodes"].size() - 1) + "/model",
+                "/versions/0/components/configuration/edges/0/name",
+                "/versions/1/name"});
+            REQUIRE(ComponentModel::validate_basic_model("{\"name\": ", validation_reg).size() == 1);
+            // Lists and objects of the wrong type are reported as well
+            nl::json mistyped_json = exported_json;
+            mistyped_json["types"] = "x";
+            mistyped_json["configured_for"] = {{"uri", "x"}};
+            mistyped_json["versions"][0]["interfaces"] = "x";
+            mistyped_json["versions"][0]["components"]["edges"] = {{"name", "x"}};
+            mistyped_json["versions"].push_back("x");
+            nl::json mistyped_errors;
+            REQUIRE_NOTHROW(mistyped_errors = ComponentModel::validate_basic_model(mistyped_json.dump(), validation_reg));
+            std::set<std::string> mistyped_paths;
+            for (const auto& error : mistyped_errors)
+                mistyped_paths.insert(error["path"].get<std::string>());
+            REQUIRE(mistyped_paths == std::set<std::string>{"/types", "/configured_for", "/versions/0/interfaces", "/versions/0/components/edges", "/versions/1"});
+            REQUIRE(ComponentModel::validate_basic_model_file("/nonexistent/basic_model.json", validation_reg).size() == 1);
+        }
+
+        SECTION("Edge configuration")
+        {
+            // Edge configurations are applied to the connections with the given name
+            const ComponentModelPtr configured(import_configured());
+            std::size_t configured_connections = 0;
+            for (const auto &[p, _] : configured->get_facts("parts"))
+            {
+                for (const auto &[i, _] : p.lock()->get_facts("interfaces"))
+                {
+                    for (const auto &[o, props] : i.lock()->get_facts("others"))
+                    {
+                        REQUIRE(props["name"] == "test");
+                        REQUIRE(props["configuration"]["buffer_size"] == 5);
+                        configured_connections += 1;
+                    }
+                }
+            }
+            REQUIRE(configured_connections == 1);
+
+            // A broken node configuration skips the version, even if the configuration is listed before the edges
+            nl::json misconfigured_json = exported_json;
+            misconfigured_json["name"] = "MisconfiguredCascadedController";
+            misconfigured_json["versions"][0]["components"]["configuration"]["nodes"] = {{{"name", "missing_part"}}};
+            REQUIRE(misconfigured_json.dump().find("\"configuration\"") < misconfigured_json.dump().find("\"edges\""));
+            REQUIRE(ComponentModel::import_from_basic_model(misconfigured_json.dump(), import_reg).size() == 0);
+            REQUIRE(ComponentModel::import_from_basic_model(misconfigured_json.dump(), import_reg, {{"parallel", true}}).size() == 0);
+        }
+
+        SECTION("export_many")
+        {
+            // Exporting does not modify the models, so many of them can be exported concurrently
+            const ComponentModelPtr configured(import_configured());
+            ComponentModelPtr unknown_facts = pr->instantiate<ComponentModel>();
+            unknown_facts->set_properties({{"name", "UnknownFacts"}, {"domain", "SOFTWARE"}, {"version", "v0.1"}, {"abstract", true}});
+            for (const std::string relation : {"model", "parts", "interfaces", "dynamic_interfaces"})
+                unknown_facts->set_unknown_fact_empty(relation);
+            REQUIRE_NOTHROW(unknown_facts->export_to_basic_model());
+            REQUIRE_FALSE(unknown_facts->has_facts("implementations"));
+            REQUIRE_FALSE(unknown_facts->has_facts("abstracts"));
+            const std::vector<ComponentModelPtr> catalog{cm2, configured, unknown_facts, cm2, configured, unknown_facts};
+            const std::vector<std::string> exports(ComponentModel::export_many(catalog, 3));
+            REQUIRE(exports.size() == catalog.size());
+            for (std::size_t index = 0; index < catalog.size(); ++index)
+                REQUIRE(exports[index] == catalog[index]->export_to_basic_model());
+        }
+
+        SECTION("Streamed export")
+        {
+            // The streamed export matches the one of the whole document
+            const ComponentModelPtr configured(import_configured());
+            for (const ComponentModelPtr& model : {cm2, configured})
+            {
+                std::ostringstream streamed;
+                export_to_basic_model(model, streamed);
+                REQUIRE(streamed.str() == model->export_to_basic_model());
+            }
+            std::size_t chunks = 0;
+            std::string written;
+            export_to_basic_model(configured, [&](const char* data, const std::size_t size) {
+                chunks += 1;
+                written.append(data, size);
+            });
+            REQUIRE(chunks > 0);
+            REQUIRE(nl::json::parse(written)["versions"][0]["components"]["configuration"]["edges"].size() == 1);
+            configured->export_to_basic_model_file(path.string());
+            REQUIRE(nl::json::parse(std::ifstream(path.string())) == configured->export_to_basic_model_json());
+            fs::remove(path);
+        }
+
+        SECTION("Parallel import")
+        {
+            // The versions can be imported in parallel
+            nl::json family_json = exported_json;
+            const nl::json version_template = family_json["versions"][0];
+            family_json["versions"] = nl::json::array();
+            for (std::size_t v = 0; v < 8; ++v)
+            {
+                nl::json version = version_template;
+                version["name"] = "v" + std::to_string(v);
+                family_json["versions"].push_back(version);
+            }
+            family_json["name"] = "SerialFamily";
+            std::vector<ComponentModelPtr> serial_family = ComponentModel::import_from_basic_model(family_json.dump(), import_reg);
+            family_json["name"] = "ParallelFamily";
+            std::vector<ComponentModelPtr> parallel_family = ComponentModel::import_from_basic_model(family_json.dump(), import_reg, {{"parallel", true}, {"max_threads", 4}});
+            REQUIRE(serial_family.size() == 8);
+            REQUIRE(parallel_family.size() == serial_family.size());
+            for (std::size_t v = 0; v < serial_family.size(); ++v)
+            {
+                REQUIRE(parallel_family[v]->get_version() == "v" + std::to_string(v));
+                nl::json serial_export = nl::json::parse(serial_family[v]->export_to_basic_model());
+                nl::json parallel_export = nl::json::parse(parallel_family[v]->export_to_basic_model());
+                // NOTE: Only the name (and therefore the uri) differs
+                parallel_export["name"] = serial_export["name"];
+                parallel_export["uri"] = serial_export["uri"];
+                REQUIRE(parallel_export == serial_export);
+            }
+        }
+
+        SECTION("Interface model cache")
+        {
+            // Every interface model is looked up only once per import (even if it could not be loaded)
+            XTypeRegistryPtr counting_reg = std::make_shared<ProjectRegistry>();
+            std::map<std::string, std::size_t> loads;
+            counting_reg->set_load_func([&](const std::string& uri) -> XTypePtr {
+                loads[uri] += 1;
+                return nullptr;
+            });
+            const nl::json unknown_if = {{"type", "UnknownType"}, {"domain", "SOFTWARE"}};
+            nl::json counted_json = {{"name", "Counted"}, {"domain", "SOFTWARE"}, {"versions", {{{"name", "v0.1"}, {"interfaces", nl::json::array()}, {"dynamic_interfaces", nl::json::array()}}}}};
+            for (const char* name : {"a", "b", "c"})
+            {
+                nl::json interface(unknown_if);
+                interface["name"] = name;
+                interface["direction"] = "INCOMING";
+                counted_json["versions"][0]["interfaces"].push_back(interface);
+            }
+            counted_json["versions"][0]["dynamic_interfaces"].push_back(unknown_if);
+            std::vector<ComponentModelPtr> counted = ComponentModel::import_from_basic_model(counted_json.dump(), counting_reg);
+            REQUIRE(counted.size() == 1);
+            InterfaceModel unknown_im;
+            unknown_im.set_properties({{"name", "UnknownType"}, {"domain", "SOFTWARE"}});
+            REQUIRE(loads[unknown_im.uri()] == 1);
+            REQUIRE(counted[0]->get_interfaces(counted[0]->get_interfaces(nullptr, "a").at(0)->get_type()).size() == 3);
+        }
+
+        SECTION("Batch load hook")
+        {
+            // With a batch load hook, all referenced models are loaded at once
+            XTypeRegistryPtr batch_reg = std::make_shared<ProjectRegistry>();
+            std::size_t single_loads = 0;
+            std::vector<std::vector<std::string>> batch_loads;
+            batch_reg->set_load_func([&](const std::string&) -> XTypePtr {
+                single_loads += 1;
+                return nullptr;
+            });
+            set_batch_load_func(batch_reg, [&](const std::vector<std::string>& uris) {
+                batch_loads.push_back(uris);
+                std::map<std::string, XTypePtr> loaded;
+                for (const auto& uri : uris)
+                {
+                    XTypeCPtr lookup = pr->get_by_uri(uri);
+                    if (!lookup)
+                        continue;
+                    REQUIRE(batch_reg->commit(lookup, true));
+                    loaded[uri] = lookup;
+                }
+                return loaded;
+            });
+            REQUIRE(get_batch_load_func(batch_reg));
+            std::vector<ComponentModelPtr> batch_imported = ComponentModel::import_from_basic_model(exported_json_str, batch_reg);
+            REQUIRE(batch_imported.size() == 1);
+            REQUIRE(nl::json::parse(batch_imported[0]->export_to_basic_model()) == nl::json::parse(cm2->export_to_basic_model()));
+            REQUIRE(batch_loads.size() == 1);
+            REQUIRE(std::find(batch_loads[0].begin(), batch_loads[0].end(), cm->uri()) != batch_loads[0].end());
+            REQUIRE(single_loads == 0);
+            set_batch_load_func(batch_reg, nullptr);
+            REQUIRE_FALSE(get_batch_load_func(batch_reg));
+        }
     }
 
     SECTION("Disconnect parts")
@@ -553,6 +1325,8 @@ TEST_CASE("Test ComponentModel real-world example", "ComponentModel")
                     const InterfacePtr ti(std::static_pointer_cast<Interface>(othersconn.lock()));
                     connections += 1;
                 }
+                // The reverse edges are gone as well
+                connections += si->get_facts("from_others").size();
             }
         }
         REQUIRE(connections == 0);
@@ -760,6 +1534,30 @@ TEST_CASE("Test abstract and concrete component models", "AbstractComponentModel
             REQUIRE(my_garage->get_part("some car")->get_name() == vehicle_part->get_name());
             REQUIRE(!my_garage->is_atomic());
         }
+        SECTION("Build a garage whose cached plan cannot be replayed")
+        {
+            ComponentModel::forget_build_plans();
+            std::string preferred(car->get_name());
+            auto select_preferred_slowly = [&](const ComponentModelPtr& abstract_model, const std::vector< ComponentModelPtr >& implementations) -> ComponentModelPtr
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                for (const auto& impl : implementations)
+                {
+                    if (impl->get_name() == preferred)
+                        return impl;
+                }
+                return nullptr;
+            };
+            garage->build("My garage", select_preferred_slowly, {{"cache_plan", true}});
+            preferred = another_car->get_name();
+            garage->build("My garage", select_preferred_slowly, {{"cache_plan", true}, {"report", true}});
+            const nl::json report(ComponentModel::get_last_build_report());
+            REQUIRE(report["source"] == "build");
+            // Validating the cached plan counts as abstract resolution, but only the resolution of the new plan is taken out of its expansion
+            REQUIRE(report["phases"]["abstract_resolution"]["wall_time_ms"].get<double>() >= 40.0);
+            REQUIRE(report["phases"]["expansion"]["wall_time_ms"].get<double>() >= 0.0);
+            ComponentModel::forget_build_plans();
+        }
 
         // Export some of the interfaces to the garage interfaces, create a park of garages, connect some of the interfaces, then build that park
         // Create a park
@@ -822,6 +1620,90 @@ TEST_CASE("Test abstract and concrete component models", "AbstractComponentModel
             REQUIRE(the_park->get_part("Other garage")->get_interface("inner horn")->get_facts("original").size() > 0);
             REQUIRE(the_park->get_part("My garage")->get_interface("inner horn")->get_facts("original")[0].target.lock()->uri() == the_park->get_part("My garage")->get_part("some car")->get_interface("horn")->uri());
         }
+
+        SECTION("Build a park with memoized and policy based implementation selection")
+        {
+            int calls = 0;
+            auto select_first_implementation = [&](const ComponentModelPtr& abstract_model, const std::vector< ComponentModelPtr >& implementations) -> ComponentModelPtr
+            {
+                calls++;
+                return implementations[0];
+            };
+            park->build("The park", select_first_implementation);
+            REQUIRE(calls == 2);
+            calls = 0;
+            // Both garages contain the same abstract vehicle, so it has to be resolved only once
+            park->build("The park", select_first_implementation, {{"memoize_selection", "model"}});
+            REQUIRE(calls == 1);
+            calls = 0;
+            // ... which is also true if we memoize by part, because both garages share the same model
+            park->build("The park", select_first_implementation, {{"memoize_selection", "part"}});
+            REQUIRE(calls == 1);
+            REQUIRE_THROWS(park->build("The park", select_first_implementation, {{"memoize_selection", "everything"}}));
+
+            // A policy does not need a callback
+            car->set_maturity("STABLE");
+            car->set_version("v0.0.9");
+            another_car->set_maturity("TESTING");
+            another_car->set_version("v0.0.10");
+            ModulePtr the_park = park->build("The park", nullptr, {{"implementation_policy", {{{"property", "maturity"}, {"prefer", {"STABLE"}}}}}});
+            REQUIRE(the_park->get_part("My garage")->get_part("some car")->get_type()->uuid() == car->uuid());
+            the_park = park->build("The park", nullptr, {{"implementation_policy", {{{"property", "version"}, {"order", "highest"}}}}});
+            REQUIRE(the_park->get_part("My garage")->get_part("some car")->get_type()->uuid() == another_car->uuid());
+            // The first criterion wins
+            the_park = park->build("The park", nullptr, {{"implementation_policy", {
+                {{"property", "maturity"}, {"prefer", {"STABLE", "TESTING"}}},
+                {{"property", "version"}, {"order", "highest"}}
+            }}});
+            REQUIRE(the_park->get_part("Other garage")->get_part("some car")->get_type()->uuid() == car->uuid());
+            ModulePtr real_car = vehicle->build("real_car", nullptr, {{"implementation_policy", {{{"property", "version"}, {"order", "lowest"}}}}});
+            REQUIRE(real_car->get_type()->uuid() == car->uuid());
+        }
+
+        SECTION("Build a park lazily")
+        {
+            auto select_first_implementation = [](const ComponentModelPtr& abstract_model, const std::vector< ComponentModelPtr >& implementations) -> ComponentModelPtr
+            {
+                return implementations[0];
+            };
+            ModulePtr eager_park = park->build("The park", select_first_implementation);
+            ModulePtr lazy_park = park->build("The lazy park", select_first_implementation, {{"lazy", true}});
+            // Nothing but the toplvl module has been created yet
+            REQUIRE(lazy_park->get_facts("parts").size() == 0);
+            REQUIRE(!lazy_park->is_atomic());
+            // Accessing a part creates all parts of the toplvl module
+            REQUIRE(lazy_park->get_part("Henning") != nullptr);
+            REQUIRE(lazy_park->get_facts("parts").size() == park->get_facts("parts").size());
+            REQUIRE(lazy_park->get_part("Henning")->get_interface("ear")->get_facts("from_others").size() == 2);
+            REQUIRE(lazy_park->get_part("My garage")->get_part("some car")->get_type()->uuid() == car->uuid());
+            REQUIRE(lazy_park->get_part("My garage")->get_interface("inner horn")->get_facts("original")[0].target.lock()->uuid() == lazy_park->get_part("My garage")->get_part("some car")->get_interface("horn")->uuid());
+            // After materializing everything, both modules have to be equal
+            lazy_park->materialize();
+            std::function< void(const ModulePtr&, const ModulePtr&) > require_equal = [&](const ModulePtr& a, const ModulePtr& b)
+            {
+                a->set_all_unknown_facts_empty();
+                b->set_all_unknown_facts_empty();
+                REQUIRE(a->get_type()->uuid() == b->get_type()->uuid());
+                REQUIRE(a->get_configuration() == b->get_configuration());
+                REQUIRE(a->get_facts("interfaces").size() == b->get_facts("interfaces").size());
+                for (const auto &[i, _] : a->get_facts("interfaces"))
+                {
+                    const InterfacePtr a_if(std::static_pointer_cast<Interface>(i.lock()));
+                    const InterfacePtr b_if(b->get_interface(a_if->get_name()));
+                    REQUIRE(b_if);
+                    REQUIRE(a_if->get_facts("others").size() == b_if->get_facts("others").size());
+                    REQUIRE(a_if->get_facts("from_others").size() == b_if->get_facts("from_others").size());
+                    REQUIRE(a_if->get_facts("original").size() == b_if->get_facts("original").size());
+                }
+                REQUIRE(a->get_facts("parts").size() == b->get_facts("parts").size());
+                for (const auto &[p, _] : a->get_facts("parts"))
+                {
+                    const ModulePtr a_part(std::static_pointer_cast<Module>(p.lock()));
+                    require_equal(a_part, b->get_part(a_part->get_name()));
+                }
+            };
+            require_equal(eager_park, lazy_park);
+        }
     }
 
     pr->clear();